@@ -0,0 +1,114 @@
+#include <stdbool.h>
+#include "beacon_config.h"
+#include "advertising_policy.h"
+
+#define MOTION_THRESHOLD            ((ADV_POLICY_MOTION_THRESHOLD_M * MICRO_DEGREES_PER_DEGREE) / METERS_PER_DEGREE)
+
+/**@brief Policy context, persists between fixes. */
+typedef struct AdvertisingPolicy
+{
+    AdvertisingPolicyStateType state;
+    bool has_anchor;
+    LocationDataType anchor;    /**< Position at the last significant move. */
+    int32_t longitude_scale;    /**< Cosine of the anchor latitude, scales longitude to latitude distance. */
+    uint32_t move_time;         /**< Time of the last significant move in ms. */
+    uint32_t burst_time;        /**< Start time of the last burst in ms. */
+    bool burst;
+} AdvertisingPolicyType;
+
+// Private data
+static AdvertisingPolicyType policy;
+
+// Private method declarations
+static void anchor_set(const LocationDataType *location);
+static bool anchor_left(const LocationDataType *location);
+
+/*
+ * Public methods
+ */
+
+/**@brief Inits the policy, the Beacon is considered moving until the first fixes prove otherwise. */
+void advertising_policy_init(void)
+{
+    policy.state = ADV_POLICY_MOVING;
+    policy.has_anchor = false;
+    policy.move_time = 0U;
+    policy.burst = false;
+}
+
+/**@brief Selects the advertising interval for a new fix.
+ *
+ * @details A move is significant if the fix leaves a circle of ADV_POLICY_MOTION_THRESHOLD_M
+ *          around the position of the last significant move, so receiver noise of a parked
+ *          asset does not count as motion. Without a significant move for
+ *          ADV_POLICY_STATIONARY_TIMEOUT_MS the Beacon is stationary and advertises with the long
+ *          interval. The first significant move of a stationary Beacon starts a burst of fast
+ *          advertisements for ADV_POLICY_BURST_DURATION_MS, afterwards the moving interval is
+ *          used.
+ *
+ * @param[in]   location    New fix.
+ * @param[in]   time_ms     Time of the fix in ms, may wrap around.
+ *
+ * @returns Advertising interval in units of 0.625 ms.
+ */
+uint32_t advertising_policy_update(const LocationDataType *location, uint32_t time_ms)
+{
+    if (!policy.has_anchor)
+    {
+        anchor_set(location);
+        policy.move_time = time_ms;
+    }
+    else if (anchor_left(location))
+    {
+        anchor_set(location);
+        policy.move_time = time_ms;
+
+        if (ADV_POLICY_STATIONARY == policy.state)
+        {
+            policy.burst = true;
+            policy.burst_time = time_ms;
+        }
+        policy.state = ADV_POLICY_MOVING;
+    }
+    else if ((time_ms - policy.move_time) >= ADV_POLICY_STATIONARY_TIMEOUT_MS)
+    {
+        policy.state = ADV_POLICY_STATIONARY;
+    }
+
+    if (policy.burst && ((time_ms - policy.burst_time) >= ADV_POLICY_BURST_DURATION_MS))
+    {
+        policy.burst = false;
+    }
+
+    if (policy.burst)
+    {
+        return BURST_ADV_INTERVAL;
+    }
+
+    return (ADV_POLICY_STATIONARY == policy.state) ? STATIONARY_ADV_INTERVAL : MOVING_ADV_INTERVAL;
+}
+
+/**@brief Returns the current motion state. */
+AdvertisingPolicyStateType advertising_policy_state(void)
+{
+    return policy.state;
+}
+
+/*
+ * Private methods
+ */
+
+/**@brief Sets the anchor, the longitude scale is computed once per anchor instead of per fix. */
+static void anchor_set(const LocationDataType *location)
+{
+    policy.anchor = *location;
+    policy.longitude_scale = location_longitude_scale(location->latitude);
+    policy.has_anchor = true;
+}
+
+/**@brief Checks whether the location is outside the motion threshold around the anchor. */
+static bool anchor_left(const LocationDataType *location)
+{
+    return location_distance_squared(&policy.anchor, location, policy.longitude_scale) >
+           ((int64_t)MOTION_THRESHOLD * MOTION_THRESHOLD);
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#ifndef ADVERTISING_POLICY_H__
+#define ADVERTISING_POLICY_H__
+
+#include <stdint.h>
+#include "location_data.h"
+
+/**@brief Motion state derived from the fix stream. */
+typedef enum AdvertisingPolicyState
+{
+    ADV_POLICY_STATIONARY,      /**< No significant move within ADV_POLICY_STATIONARY_TIMEOUT_MS. */
+    ADV_POLICY_MOVING           /**< Significant move within ADV_POLICY_STATIONARY_TIMEOUT_MS. */
+} AdvertisingPolicyStateType;
+
+void advertising_policy_init(void);
+uint32_t advertising_policy_update(const LocationDataType *location, uint32_t time_ms);
+AdvertisingPolicyStateType advertising_policy_state(void);
+
+#endif // ADVERTISING_POLICY_H__
\ No newline at end of file
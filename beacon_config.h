@@ -2,14 +2,77 @@
 #define BEACON_CONFIG_H__
 
 #include "app_util.h"
-#include "location_service.h"
+#include "beacon_payload.h"
 
 #define DEVICE_NAME                     "GNSS Beacon"                                           /**< Device name. */
 #define APP_BLE_CONN_CFG_TAG            1                                                       /**< A tag identifying the SoftDevice BLE configuration. */
+#define APP_BLE_OBSERVER_PRIO           3                                                       /**< Application's BLE observer priority. */
+
+#ifndef BEACON_CONNECTABLE
+#define BEACON_CONNECTABLE              0                                                       /**< Accept a connection and provide the Location and Navigation Service. */
+#endif
+
+#define MIN_CONN_INTERVAL               MSEC_TO_UNITS(40, UNIT_1_25_MS)                         /**< Minimum preferred connection interval (40 ms), above NRF_SDH_BLE_GAP_EVENT_LENGTH to leave time for advertising. */
+#define MAX_CONN_INTERVAL               MSEC_TO_UNITS(50, UNIT_1_25_MS)                         /**< Maximum preferred connection interval (50 ms), below the fix interval. */
+#define SLAVE_LATENCY                   0                                                       /**< Slave latency. */
+#define CONN_SUP_TIMEOUT                MSEC_TO_UNITS(4000, UNIT_10_MS)                         /**< Connection supervisory timeout (4 s). */
+#define HVN_TX_QUEUE_SIZE               16U                                                     /**< Notifications queued in the SoftDevice per connection. */
 
 #define NON_CONNECTABLE_ADV_INTERVAL    MSEC_TO_UNITS(100, UNIT_0_625_MS)                       /**< The advertising interval for non-connectable advertisement (100 ms). This value can vary between 100ms to 10.24s). */
 
-#define APP_BEACON_INFO_LENGTH          (LATITUDE_MAX_DATA_SIZE+LONGITUDE_MAX_DATA_SIZE+1U)     /**< Total length of information advertised by the Beacon. */
+#ifndef BEACON_ADV_ADAPTIVE
+#define BEACON_ADV_ADAPTIVE             1                                                       /**< Select the advertising interval by motion state, see advertising_policy.c. */
+#endif
+
+#define STATIONARY_ADV_INTERVAL         MSEC_TO_UNITS(1000, UNIT_0_625_MS)                      /**< Advertising interval of a parked Beacon (1 s). */
+#define MOVING_ADV_INTERVAL             NON_CONNECTABLE_ADV_INTERVAL                            /**< Advertising interval of a moving Beacon. */
+#define BURST_ADV_INTERVAL              MSEC_TO_UNITS(20, UNIT_0_625_MS)                        /**< Advertising interval right after a parked Beacon starts moving (20 ms, minimum). */
+
+#define ADV_POLICY_MOTION_THRESHOLD_M   15L                                                     /**< Distance from the last position considered a significant move, above receiver noise. */
+#define ADV_POLICY_STATIONARY_TIMEOUT_MS 30000UL                                                /**< Time without significant move until the Beacon is considered parked. */
+#define ADV_POLICY_BURST_DURATION_MS    2000UL                                                  /**< Duration of the fast advertising burst. */
+
+#ifndef BEACON_DEADBAND_M
+#define BEACON_DEADBAND_M               5UL                                                     /**< Fixes within this distance of the advertised position are not advertised, 0 to skip unchanged positions only. */
+#endif
+
+#define BEACON_MAX_SILENCE_MS           10000UL                                                 /**< An unchanged position is advertised again after this time, below ADV_POLICY_STATIONARY_TIMEOUT_MS. */
+#define BEACON_MIN_UPDATE_INTERVAL_MS   100UL                                                   /**< Minimum time between advertising data updates, faster fixes would be replaced before going on air. */
+
+#define BEACON_ADV_LEGACY               0                                                       /**< Legacy advertising on 1M PHY, up to 31 bytes. */
+#define BEACON_ADV_EXTENDED             1                                                       /**< BLE 5 extended advertising, up to 255 bytes. */
+
+#ifndef BEACON_ADV_MODE
+#define BEACON_ADV_MODE                 BEACON_ADV_LEGACY                                       /**< Advertising mode of the Beacon. */
+#endif
+
+#ifndef BEACON_SCAN_TELEMETRY
+#define BEACON_SCAN_TELEMETRY           1                                                       /**< Legacy advertising only, telemetry in the scan response, refreshed on scan requests. */
+#endif
+
+#define TELEMETRY_REFRESH_INTERVAL_MS   1000UL                                                  /**< Minimum time between telemetry refreshes while scan requests arrive. */
+
+#ifndef BEACON_ADV_PRIMARY_PHY
+#define BEACON_ADV_PRIMARY_PHY          BLE_GAP_PHY_CODED                                       /**< Extended advertising only, BLE_GAP_PHY_1MBPS or BLE_GAP_PHY_CODED (S8, long range). */
+#endif
+
+#ifndef BEACON_ADV_SECONDARY_PHY
+#define BEACON_ADV_SECONDARY_PHY        BLE_GAP_PHY_CODED                                       /**< Extended advertising only, BLE_GAP_PHY_1MBPS, BLE_GAP_PHY_2MBPS (short airtime) or BLE_GAP_PHY_CODED. */
+#endif
+
+#if (BEACON_ADV_MODE == BEACON_ADV_EXTENDED) && BEACON_CONNECTABLE
+#define BEACON_ADV_DATA_SIZE_MAX        BLE_GAP_ADV_SET_DATA_SIZE_EXTENDED_CONNECTABLE_MAX_SUPPORTED    /**< Maximum size of the encoded advertising data. */
+#elif (BEACON_ADV_MODE == BEACON_ADV_EXTENDED)
+#define BEACON_ADV_DATA_SIZE_MAX        BLE_GAP_ADV_SET_DATA_SIZE_EXTENDED_MAX_SUPPORTED        /**< Maximum size of the encoded advertising data. */
+#else
+#define BEACON_ADV_DATA_SIZE_MAX        BLE_GAP_ADV_SET_DATA_SIZE_MAX                           /**< Maximum size of the encoded advertising data. */
+#endif
+
+#ifndef BEACON_ADV_BUFFER_COUNT
+#define BEACON_ADV_BUFFER_COUNT         3U                                                      /**< Advertising buffers: advertised, replaced until the radio event ends, pending. */
+#endif
+
+#define APP_BEACON_INFO_LENGTH          BEACON_PAYLOAD_LENGTH                                   /**< Total length of information advertised by the Beacon. */
 #define APP_COMPANY_IDENTIFIER          0xFFFF                                                  /**< Undefined company ID. */
 
 #endif // BEACON_CONFIG_H__
\ No newline at end of file
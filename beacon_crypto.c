@@ -0,0 +1,195 @@
+#include <string.h>
+#include "nrf_soc.h"
+#include "app_error.h"
+#include "beacon_crypto.h"
+
+#define KEY_LABEL_ENCRYPTION        0x01U   /**< First byte of the block deriving the encryption key. */
+#define KEY_LABEL_AUTHENTICATION    0x02U   /**< First byte of the block deriving the CMAC key. */
+#define CMAC_RB                     0x87U   /**< Constant of the CMAC subkey generation. */
+#define CMAC_PADDING                0x80U
+
+// Private data
+static const uint8_t master_key[BEACON_CRYPTO_BLOCK_SIZE] = BEACON_CRYPTO_KEY;
+static nrf_ecb_hal_data_t ecb_encryption;   /**< Key of the CTR encryption. */
+static nrf_ecb_hal_data_t ecb_authentication;   /**< Key of the CMAC. */
+static uint8_t cmac_k1[BEACON_CRYPTO_BLOCK_SIZE];  /**< CMAC subkey for complete last blocks. */
+static uint8_t cmac_k2[BEACON_CRYPTO_BLOCK_SIZE];  /**< CMAC subkey for padded last blocks. */
+static uint8_t boot_id[BEACON_CRYPTO_NONCE_LENGTH / 2U];
+static uint32_t counter;
+
+// Private method declarations
+static void block_encrypt(nrf_ecb_hal_data_t *ecb);
+static void key_derive(uint8_t label, nrf_ecb_hal_data_t *ecb);
+static void subkey_derive(const uint8_t *input, uint8_t *subkey);
+
+/*
+ * Public methods
+ */
+
+/**@brief Derives the keys from BEACON_CRYPTO_KEY and draws a random boot identifier.
+ *
+ * @details Separate keys are used for encryption and authentication. The boot identifier is
+ *          part of every nonce, so nonces of different boots differ although the message counter
+ *          restarts. Needs the SoftDevice to be enabled.
+ */
+void beacon_crypto_init(void)
+{
+    uint32_t err_code;
+    uint8_t available = 0U;
+
+    key_derive(KEY_LABEL_ENCRYPTION, &ecb_encryption);
+    key_derive(KEY_LABEL_AUTHENTICATION, &ecb_authentication);
+
+    // L = AES(K, 0), K1 = L << 1, K2 = K1 << 1, see RFC 4493.
+    memset(ecb_authentication.cleartext, 0, BEACON_CRYPTO_BLOCK_SIZE);
+    block_encrypt(&ecb_authentication);
+    subkey_derive(ecb_authentication.ciphertext, cmac_k1);
+    subkey_derive(cmac_k1, cmac_k2);
+
+    while (available < sizeof(boot_id))
+    {
+        err_code = sd_rand_application_bytes_available_get(&available);
+        APP_ERROR_CHECK(err_code);
+    }
+    err_code = sd_rand_application_vector_get(boot_id, sizeof(boot_id));
+    APP_ERROR_CHECK(err_code);
+
+    counter = 0UL;
+}
+
+/**@brief Returns the next nonce, boot identifier followed by the little endian message counter.
+ *
+ * @param[out]  nonce   Buffer of BEACON_CRYPTO_NONCE_LENGTH bytes.
+ */
+void beacon_crypto_nonce_next(uint8_t *nonce)
+{
+    ++counter;
+
+    memcpy(nonce, boot_id, sizeof(boot_id));
+    nonce[4U] = (uint8_t)counter;
+    nonce[5U] = (uint8_t)(counter >> 8);
+    nonce[6U] = (uint8_t)(counter >> 16);
+    nonce[7U] = (uint8_t)(counter >> 24);
+}
+
+/**@brief Encrypts or decrypts data of up to one block with AES-CTR.
+ *
+ * @details The counter block is the nonce padded with zeros, a nonce must not be used twice.
+ *
+ * @param[in]       nonce   Nonce of BEACON_CRYPTO_NONCE_LENGTH bytes.
+ * @param[in,out]   data    Data, en- or decrypted in place.
+ * @param[in]       length  Length of the data, at most BEACON_CRYPTO_BLOCK_SIZE.
+ */
+void beacon_crypto_ctr(const uint8_t *nonce, uint8_t *data, uint8_t length)
+{
+    memcpy(ecb_encryption.cleartext, nonce, BEACON_CRYPTO_NONCE_LENGTH);
+    memset(&ecb_encryption.cleartext[BEACON_CRYPTO_NONCE_LENGTH], 0,
+           BEACON_CRYPTO_BLOCK_SIZE - BEACON_CRYPTO_NONCE_LENGTH);
+    block_encrypt(&ecb_encryption);
+
+    for (uint8_t idx = 0U; idx < length; ++idx)
+    {
+        data[idx] ^= ecb_encryption.ciphertext[idx];
+    }
+}
+
+/**@brief Computes the AES-CMAC of the data, truncated to BEACON_CRYPTO_MAC_LENGTH bytes.
+ *
+ * @param[in]   data    Data.
+ * @param[in]   length  Length of the data.
+ * @param[out]  mac     Buffer of BEACON_CRYPTO_MAC_LENGTH bytes.
+ */
+void beacon_crypto_mac(const uint8_t *data, uint8_t length, uint8_t *mac)
+{
+    uint8_t *state = ecb_authentication.cleartext;
+    uint8_t offset = 0U;
+
+    memset(ecb_authentication.ciphertext, 0, BEACON_CRYPTO_BLOCK_SIZE);
+
+    // Complete blocks except the last one.
+    while ((length - offset) > BEACON_CRYPTO_BLOCK_SIZE)
+    {
+        for (uint8_t idx = 0U; idx < BEACON_CRYPTO_BLOCK_SIZE; ++idx)
+        {
+            state[idx] = ecb_authentication.ciphertext[idx] ^ data[offset + idx];
+        }
+        block_encrypt(&ecb_authentication);
+        offset += BEACON_CRYPTO_BLOCK_SIZE;
+    }
+
+    // Last block, padded if incomplete.
+    for (uint8_t idx = 0U; idx < BEACON_CRYPTO_BLOCK_SIZE; ++idx)
+    {
+        uint8_t value;
+
+        if ((offset + idx) < length)
+        {
+            value = data[offset + idx] ^ (((length - offset) == BEACON_CRYPTO_BLOCK_SIZE) ? cmac_k1[idx] : cmac_k2[idx]);
+        }
+        else
+        {
+            value = (((offset + idx) == length) ? CMAC_PADDING : 0U) ^ cmac_k2[idx];
+        }
+        state[idx] = ecb_authentication.ciphertext[idx] ^ value;
+    }
+    block_encrypt(&ecb_authentication);
+
+    memcpy(mac, ecb_authentication.ciphertext, BEACON_CRYPTO_MAC_LENGTH);
+}
+
+/**@brief Verifies the truncated AES-CMAC of the data in constant time.
+ *
+ * @returns true if the MAC matches, false otherwise.
+ */
+bool beacon_crypto_mac_verify(const uint8_t *data, uint8_t length, const uint8_t *mac)
+{
+    uint8_t expected[BEACON_CRYPTO_MAC_LENGTH];
+    uint8_t difference = 0U;
+
+    beacon_crypto_mac(data, length, expected);
+
+    for (uint8_t idx = 0U; idx < BEACON_CRYPTO_MAC_LENGTH; ++idx)
+    {
+        difference |= expected[idx] ^ mac[idx];
+    }
+
+    return (0U == difference);
+}
+
+/*
+ * Private methods
+ */
+
+/**@brief Encrypts the cleartext block with the AES ECB peripheral, shared with the SoftDevice. */
+static void block_encrypt(nrf_ecb_hal_data_t *ecb)
+{
+    uint32_t err_code = sd_ecb_block_encrypt(ecb);
+    APP_ERROR_CHECK(err_code);
+}
+
+/**@brief Derives a key as AES(master key, label || 0). */
+static void key_derive(uint8_t label, nrf_ecb_hal_data_t *ecb)
+{
+    memcpy(ecb->key, master_key, BEACON_CRYPTO_BLOCK_SIZE);
+    memset(ecb->cleartext, 0, BEACON_CRYPTO_BLOCK_SIZE);
+    ecb->cleartext[0U] = label;
+    block_encrypt(ecb);
+    memcpy(ecb->key, ecb->ciphertext, BEACON_CRYPTO_BLOCK_SIZE);
+}
+
+/**@brief Shifts the block left by one bit, the constant Rb is added if the MSB was set. */
+static void subkey_derive(const uint8_t *input, uint8_t *subkey)
+{
+    uint8_t msb = input[0U] & 0x80U;
+
+    for (uint8_t idx = 0U; idx < (BEACON_CRYPTO_BLOCK_SIZE - 1U); ++idx)
+    {
+        subkey[idx] = (uint8_t)(input[idx] << 1) | (input[idx + 1U] >> 7);
+    }
+    subkey[BEACON_CRYPTO_BLOCK_SIZE - 1U] = (uint8_t)(input[BEACON_CRYPTO_BLOCK_SIZE - 1U] << 1);
+
+    if (0U != msb)
+    {
+        subkey[BEACON_CRYPTO_BLOCK_SIZE - 1U] ^= CMAC_RB;
+    }
+}
\ No newline at end of file
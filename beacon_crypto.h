@@ -0,0 +1,27 @@
+#ifndef BEACON_CRYPTO_H__
+#define BEACON_CRYPTO_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "beacon_payload.h"
+
+// AES-128 master key, has to be given at build time for the secure payload format.
+#ifndef BEACON_CRYPTO_KEY
+#if (BEACON_PAYLOAD_FORMAT == BEACON_PAYLOAD_SECURE)
+#error "BEACON_CRYPTO_KEY is not defined, e.g. CFLAGS += -DBEACON_CRYPTO_KEY=\"{ 0x00, ... }\""
+#else
+#define BEACON_CRYPTO_KEY           {0U}    /**< Unused, the payload format is not secure. */
+#endif
+#endif
+
+#define BEACON_CRYPTO_BLOCK_SIZE    16U     /**< AES block size, maximum length of encrypted data. */
+#define BEACON_CRYPTO_NONCE_LENGTH  8U      /**< Boot identifier and message counter. */
+#define BEACON_CRYPTO_MAC_LENGTH    4U      /**< Truncated CMAC. */
+
+void beacon_crypto_init(void);
+void beacon_crypto_nonce_next(uint8_t *nonce);
+void beacon_crypto_ctr(const uint8_t *nonce, uint8_t *data, uint8_t length);
+void beacon_crypto_mac(const uint8_t *data, uint8_t length, uint8_t *mac);
+bool beacon_crypto_mac_verify(const uint8_t *data, uint8_t length, const uint8_t *mac);
+
+#endif // BEACON_CRYPTO_H__
\ No newline at end of file
@@ -5,21 +5,82 @@
 #include "nrf_sdh.h"
 #include "nrf_sdh_ble.h"
 #include "ble_advdata.h"
+#include "app_timer.h"
+#include "app_util_platform.h"
+#include "ble_radio_notification.h"
+#include "nrf_ble_gatt.h"
 #include "beacon_config.h"
 #include "beacon_manager.h"
 #include "location_service.h"
+#include "advertising_policy.h"
+#include "navigation_service.h"
+#include "beacon_crypto.h"
+#include "beacon_telemetry.h"
 
 #define DEAD_BEEF 0xDEADBEEF /**< Value used as error code on stack dump, can be used to identify stack location on stack unwind. */
-#define BEACON_INFO_INIT_DATA \
-         '+', '0', '0', '.', '0', '0', '0', '0', '0', '0', ',', \
-    '+', '0', '0', '0', '.', '0', '0', '0', '0', '0', '0'
+#define MANUF_DATA_HEADER_LENGTH        4U                                                  /**< AD length, AD type and company identifier. */
+#define APP_TIMER_TICK_FREQ             (APP_TIMER_CLOCK_FREQ / (APP_TIMER_CONFIG_RTC_FREQUENCY + 1U))
+#define RADIO_NOTIFICATION_DISTANCE     NRF_RADIO_NOTIFICATION_DISTANCE_800US               /**< Notification ahead of each radio event. */
+#define RADIO_NOTIFICATION_DISTANCE_US  800U                                                /**< Notification distance in us. */
+#define ADV_BUFFER_NONE                 0xFFU                                               /**< No advertising buffer. */
+#define SCAN_TELEMETRY                  (BEACON_SCAN_TELEMETRY && (BEACON_ADV_MODE == BEACON_ADV_LEGACY))   /**< Only legacy advertising is scannable. */
+#define TELEMETRY_REFRESH_TICKS         APP_TIMER_TICKS(TELEMETRY_REFRESH_INTERVAL_MS)
+
+#if (BEACON_ADV_MODE == BEACON_ADV_LEGACY)
+#define ADV_TYPE_NONCONNECTABLE         BLE_GAP_ADV_TYPE_NONCONNECTABLE_SCANNABLE_UNDIRECTED
+#define ADV_TYPE_CONNECTABLE            BLE_GAP_ADV_TYPE_CONNECTABLE_SCANNABLE_UNDIRECTED
+#else
+#define ADV_TYPE_NONCONNECTABLE         BLE_GAP_ADV_TYPE_EXTENDED_NONCONNECTABLE_NONSCANNABLE_UNDIRECTED
+#define ADV_TYPE_CONNECTABLE            BLE_GAP_ADV_TYPE_EXTENDED_CONNECTABLE_NONSCANNABLE_UNDIRECTED
+#endif
+
+/**@brief Ownership of an advertising buffer. */
+typedef enum AdvBufferState
+{
+    ADV_BUFFER_FREE,            /**< Available for the next payload. */
+    ADV_BUFFER_WRITING,         /**< Payload being encoded by the application. */
+    ADV_BUFFER_PENDING,         /**< Payload encoded, waits for the next advertising event. */
+    ADV_BUFFER_ON_AIR,          /**< Owned by the SoftDevice, advertised. */
+    ADV_BUFFER_RELEASING        /**< Replaced, the SoftDevice may read it until the radio event ends. */
+} AdvBufferStateType;
 
 // Private data
-static int8_t m_ls_handle;                                          /**< Location service handle. */
+static int8_t m_ls_handle;                                          /**< Location service handle, filtered by the deadband. */
+static int8_t m_track_ls_handle;                                    /**< Location service handle of every fix. */
 static ble_gap_adv_params_t m_adv_params;                           /**< Parameters to be passed to the stack when starting advertising. */
 static uint8_t m_adv_handle = BLE_GAP_ADV_SET_HANDLE_NOT_SET;       /**< Advertising handle used to identify an advertising set. */
-static uint8_t m_enc_advdata[2U][BLE_GAP_ADV_SET_DATA_SIZE_MAX];    /**< Buffer for storing an encoded advertising set. */
-static uint8_t m_enc_srdata[2U][BLE_GAP_ADV_SET_DATA_SIZE_MAX];     /**< Buffer for storing an encoded scan response set. */
+static uint8_t m_enc_advdata[BEACON_ADV_BUFFER_COUNT][BEACON_ADV_DATA_SIZE_MAX];     /**< Buffers for storing an encoded advertising set. */
+#if (BEACON_ADV_MODE == BEACON_ADV_LEGACY)
+static uint8_t m_enc_srdata[BEACON_ADV_BUFFER_COUNT][BLE_GAP_ADV_SET_DATA_SIZE_MAX]; /**< Buffers for storing an encoded scan response set. */
+#endif
+static AdvBufferStateType m_buffer_state[BEACON_ADV_BUFFER_COUNT];  /**< Ownership of the advertising buffers, modified within critical regions only. */
+static uint8_t m_on_air_idx;                                        /**< Buffer index owned by the SoftDevice. */
+static BeaconBufferStatsType m_buffer_stats;                        /**< Coalesced and dropped updates. */
+static uint16_t m_beacon_info_offset;                               /**< Offset of the beacon information within the encoded advertising data. */
+static uint8_t m_beacon_info_capacity;                              /**< Space available for the beacon information. */
+static uint8_t m_sequence;                                          /**< Sequence counter of the binary beacon payload. */
+static BeaconTrackType m_track;                                     /**< Recent fixes, advertised by the track payload. */
+static uint64_t m_fix_ticks;                                        /**< Time base of the fixes, extends the app_timer counter. */
+static uint32_t m_last_fix_cnt;                                     /**< app_timer counter when the last fix was received. */
+static uint32_t m_fix_count;                                        /**< Fixes added to the track, wraps around. */
+static uint32_t m_encoded_fix_count;                                /**< m_fix_count at the last payload update. */
+static bool m_advertising;                                          /**< Advertising has been started. */
+static volatile uint8_t m_pending_idx = ADV_BUFFER_NONE;            /**< Buffer index of the payload waiting for the next advertising event. */
+static uint16_t m_pending_length;                                   /**< Advertising data length of the pending payload. */
+static uint32_t m_pending_fix_cnt;                                  /**< app_timer counter at the fix of the pending payload. */
+static bool m_pending_fix;                                          /**< Pending payload carries a new fix, not only new telemetry. */
+static BeaconLatencyType m_latency;                                 /**< Fix-to-air delay statistics. */
+#if SCAN_TELEMETRY
+static uint8_t m_telemetry[BEACON_TELEMETRY_LENGTH];                /**< Telemetry encoded into the initial scan response. */
+static uint8_t m_telemetry_offset;                                  /**< Offset of the telemetry within the encoded scan response data. */
+static uint32_t m_telemetry_cnt;                                    /**< app_timer counter at the last telemetry refresh. */
+static volatile bool m_scan_requested;                              /**< Scan requests arrived since the last telemetry refresh. */
+#endif
+#if BEACON_CONNECTABLE
+static uint16_t m_conn_handle = BLE_CONN_HANDLE_INVALID;            /**< Handle of the current connection. */
+static bool m_phy_update_pending;                                   /**< 2M PHY not yet requested. */
+NRF_BLE_GATT_DEF(m_gatt);                                           /**< GATT module instance, negotiates MTU and data length. */
+#endif
 
 /**@brief Struct that contains pointers to the encoded advertising and scan response data. */
 static ble_gap_adv_data_t m_adv_data =
@@ -27,18 +88,34 @@ static ble_gap_adv_data_t m_adv_data =
     .adv_data =
     {
         .p_data = m_enc_advdata[0U],
-        .len = BLE_GAP_ADV_SET_DATA_SIZE_MAX
+        .len = BEACON_ADV_DATA_SIZE_MAX
     },
+#if (BEACON_ADV_MODE == BEACON_ADV_LEGACY)
     .scan_rsp_data =
     {
         .p_data = m_enc_srdata[0U],
         .len = BLE_GAP_ADV_SET_DATA_SIZE_MAX
     }
+#else
+    .scan_rsp_data =
+    {
+        .p_data = NULL,     // Extended non-scannable advertising has no scan response.
+        .len = 0U
+    }
+#endif
 };
 
-static uint8_t m_beacon_info[APP_BEACON_INFO_LENGTH] = /**< Information advertised by the Beacon. */
+static uint8_t m_beacon_info[APP_BEACON_INFO_LENGTH];               /**< Information advertised by the Beacon until the first fix. */
+
+/**@brief Fixes within the deadband around the advertised position or faster than the advertiser's
+ *        own rate do not re-encode the advertising data. The track and the advertising policy
+ *        still get every fix.
+ */
+static const LocationFilterType m_location_filter =
 {
-    BEACON_INFO_INIT_DATA
+    .deadband_m = BEACON_DEADBAND_M,
+    .max_silence_ms = BEACON_MAX_SILENCE_MS,
+    .min_interval_ms = BEACON_MIN_UPDATE_INTERVAL_MS
 };
 
 // Private method declarations
@@ -46,6 +123,26 @@ static void ble_stack_init(void);
 static void gap_params_init(void);
 static void advertising_init(void);
 static void beacon_manager_accept(const LocationDataType * location_data);
+static void beacon_manager_track_accept(const LocationDataType * location_data);
+static void payload_update(uint32_t interval);
+static void advertising_update(uint32_t interval);
+static void payload_commit(uint8_t idx, uint32_t lead_us);
+static uint8_t buffer_claim(bool *pending);
+static uint8_t buffer_acquire(void);
+static void buffers_release(void);
+static void radio_notification_handler(bool radio_active);
+#if SCAN_TELEMETRY
+static void telemetry_refresh(void);
+#endif
+#if BEACON_CONNECTABLE || SCAN_TELEMETRY
+static void ble_evt_handler(ble_evt_t const *p_ble_evt, void *p_context);
+#endif
+#if BEACON_CONNECTABLE
+static void gatt_init(void);
+static void advertising_type_set(uint8_t type, bool stop);
+static void phy_update_request(void);
+#endif
+static uint32_t fix_time_get(uint32_t cnt);
 
 /*
  * Public methods
@@ -54,15 +151,39 @@ static void beacon_manager_accept(const LocationDataType * location_data);
 /**@brief Inits Beacon Manager module. */
 void beacon_manager_init(void)
 {
+    uint32_t err_code;
+
     ble_stack_init();
     gap_params_init();
+#if BEACON_CONNECTABLE
+    gatt_init();
+#endif
+#if SCAN_TELEMETRY
+    beacon_telemetry_init();
+#endif
     advertising_init();
 
+    err_code = ble_radio_notification_init(APP_IRQ_PRIORITY_LOW, RADIO_NOTIFICATION_DISTANCE,
+                                           radio_notification_handler);
+    APP_ERROR_CHECK(err_code);
+
+    // Subscribed first, so the track holds a fix before it is encoded
+    m_track_ls_handle = location_service_subscribe(&beacon_manager_track_accept);
+    if (m_track_ls_handle < 0)
+    {
+        // All subscriber slots taken, see MAX_SUBSCRIBERS
+        APP_ERROR_CHECK(NRF_ERROR_NO_MEM);
+    }
+    (void)location_service_priority_set(m_track_ls_handle, LOCATION_PRIORITY_HIGH);
+
     m_ls_handle = location_service_subscribe(&beacon_manager_accept);
-    if(m_ls_handle < 0)
+    if (m_ls_handle < 0)
     {
-        /* todo: error handling in case subscription fails. */
+        // All subscriber slots taken, see MAX_SUBSCRIBERS
+        APP_ERROR_CHECK(NRF_ERROR_NO_MEM);
     }
+    (void)location_service_filter_set(m_ls_handle, &m_location_filter);
+    (void)location_service_priority_set(m_ls_handle, LOCATION_PRIORITY_HIGH);
 }
 
 /**@brief Function for starting advertising. */
@@ -72,11 +193,56 @@ void beacon_advertising_start(void)
 
     err_code = sd_ble_gap_adv_start(m_adv_handle, APP_BLE_CONN_CFG_TAG);
     APP_ERROR_CHECK(err_code);
+    m_advertising = true;
 
     err_code = bsp_indication_set(BSP_INDICATE_ADVERTISING);
     APP_ERROR_CHECK(err_code);
 }
 
+/**@brief Refreshes the telemetry in the scan response, to be called from the main loop.
+ *
+ * @details Telemetry is only collected if scan requests arrived since the last refresh, at most
+ *          once per TELEMETRY_REFRESH_INTERVAL_MS. So its cost, including the supply voltage
+ *          measurement, is only paid while scanners are actually reading it. The refreshed scan
+ *          response is committed right before the next advertising event, like a new payload.
+ */
+void beacon_manager_update(void)
+{
+#if SCAN_TELEMETRY
+    if (!m_scan_requested ||
+        (app_timer_cnt_diff_compute(app_timer_cnt_get(), m_telemetry_cnt) < TELEMETRY_REFRESH_TICKS))
+    {
+        return;
+    }
+
+    m_scan_requested = false;
+    m_telemetry_cnt = app_timer_cnt_get();
+    telemetry_refresh();
+#endif
+}
+
+/**@brief Returns the fix-to-air delay statistics of the advertised payloads.
+ *
+ * @param[out]  latency     Copy of the statistics.
+ */
+void beacon_manager_latency_get(BeaconLatencyType *latency)
+{
+    CRITICAL_REGION_ENTER();
+    *latency = m_latency;
+    CRITICAL_REGION_EXIT();
+}
+
+/**@brief Returns the counters of advertising updates not passed to the stack.
+ *
+ * @param[out]  stats       Copy of the counters.
+ */
+void beacon_manager_buffer_stats_get(BeaconBufferStatsType *stats)
+{
+    CRITICAL_REGION_ENTER();
+    *stats = m_buffer_stats;
+    CRITICAL_REGION_EXIT();
+}
+
 /**@brief Callback function for asserts in the SoftDevice.
  *
  * @details This function will be called in case of an assert in the SoftDevice.
@@ -99,65 +265,539 @@ void assert_nrf_callback(uint16_t line_num, const uint8_t *p_file_name)
 
 /**@brief Subscription function for accepting new location data
  *
- * @details This function can be used to subscribe to a location server and
- *          updates the advertised location data.
+ * @details Subscribed with the deadband filter, updates the advertised location data from the
+ *          track. The fix has already been added by @ref beacon_manager_track_accept.
  *
  * @param[in]   location_data   Pointer to location data.
  */
 static void beacon_manager_accept(const LocationDataType *location_data)
+{
+    UNUSED_PARAMETER(location_data);
+
+    payload_update(m_adv_params.interval);
+}
+
+/**@brief Subscription function for accepting every fix
+ *
+ * @details Adds the fix to the track and feeds the advertising policy. A new advertising interval
+ *          is applied right away, also for fixes within the deadband, so a burst ends on time.
+ *
+ * @param[in]   location_data   Pointer to location data.
+ */
+static void beacon_manager_track_accept(const LocationDataType *location_data)
+{
+    uint32_t fix_time = fix_time_get(location_service_fix_timestamp_get());
+
+    beacon_track_add(&m_track, location_data, fix_time);
+    m_fix_count++;
+#if BEACON_ADV_ADAPTIVE
+    uint32_t interval = advertising_policy_update(location_data, fix_time * BEACON_TRACK_TIME_UNIT_MS);
+    if (interval != m_adv_params.interval)
+    {
+        payload_update(interval);
+    }
+#endif
+}
+
+/**@brief Updates the advertised location data from the track.
+ *
+ * @details All advertising buffers hold the same
+ *          pre-encoded packet, so only the beacon information within a free buffer is
+ *          overwritten before it is passed to the stack. The length of the beacon information
+ *          only changes with the track payload, which fills the space left in the packet.
+ *          The advertising interval is selected by the advertising policy from the fix stream.
+ *
+ *          While advertising, the payload is not passed to the stack right away but committed by
+ *          the radio notification right before the next advertising event, so it goes on air
+ *          with minimal delay. A payload still pending is coalesced, its buffer is reused for the
+ *          newer one. If no buffer is free, the update is dropped. The track payload still
+ *          carries the fix with the next update. The payload is only encoded once per fix.
+ *
+ * @param[in]   interval    Advertising interval, restarts advertising if changed.
+ */
+static void payload_update(uint32_t interval)
+{
+    uint8_t idx;
+    uint8_t length;
+    bool pending;
+
+    if ((m_encoded_fix_count == m_fix_count) && (interval == m_adv_params.interval))
+    {
+        return;
+    }
+    m_encoded_fix_count = m_fix_count;
+
+    idx = buffer_claim(&pending);
+    if (ADV_BUFFER_NONE == idx)
+    {
+        m_buffer_stats.dropped++;
+        return;
+    }
+    if (pending && m_pending_fix)
+    {
+        m_buffer_stats.coalesced++;
+    }
+
+    length = beacon_payload_encode(&m_track, ++m_sequence, &m_enc_advdata[idx][m_beacon_info_offset],
+                                   m_beacon_info_capacity);
+    m_enc_advdata[idx][m_beacon_info_offset - MANUF_DATA_HEADER_LENGTH] = length + MANUF_DATA_HEADER_LENGTH - 1U;
+
+    m_pending_length = m_beacon_info_offset + length;
+    m_pending_fix_cnt = m_last_fix_cnt;
+    m_pending_fix = true;
+
+    if (m_advertising && (interval == m_adv_params.interval))
+    {
+        CRITICAL_REGION_ENTER();
+        m_buffer_state[idx] = ADV_BUFFER_PENDING;
+        m_pending_idx = idx;
+        CRITICAL_REGION_EXIT();
+    }
+    else
+    {
+        // Restarting advertising with a new interval starts a new advertising event anyway.
+        CRITICAL_REGION_ENTER();
+        payload_commit(idx, 0U);
+        CRITICAL_REGION_EXIT();
+        advertising_update(interval);
+
+        // Stopped or not yet started, the SoftDevice holds no other buffer.
+        CRITICAL_REGION_ENTER();
+        buffers_release();
+        CRITICAL_REGION_EXIT();
+    }
+}
+
+/**@brief Switches the advertising data to the given buffer and records the delay of its payload.
+ *
+ * @details The buffer advertised so far is released once the next radio event is over. A
+ *          telemetry refresh without a new fix is not recorded.
+ *
+ * @param[in]   idx         Buffer index of the payload.
+ * @param[in]   lead_us     Time until the payload goes on air.
+ */
+static void payload_commit(uint8_t idx, uint32_t lead_us)
+{
+    uint32_t ticks = app_timer_cnt_diff_compute(app_timer_cnt_get(), m_pending_fix_cnt);
+    uint32_t delay_us = (uint32_t)(((uint64_t)ticks * 1000000U) / APP_TIMER_TICK_FREQ) + lead_us;
+
+    m_buffer_state[m_on_air_idx] = ADV_BUFFER_RELEASING;
+    m_buffer_state[idx] = ADV_BUFFER_ON_AIR;
+    m_on_air_idx = idx;
+
+    // The stack requires new buffers for both advertising and scan response data on update.
+    m_adv_data.adv_data.p_data = m_enc_advdata[idx];
+    m_adv_data.adv_data.len = m_pending_length;
+#if (BEACON_ADV_MODE == BEACON_ADV_LEGACY)
+    m_adv_data.scan_rsp_data.p_data = m_enc_srdata[idx];
+#endif
+
+    if (!m_pending_fix)
+    {
+        return;
+    }
+
+    if ((0U == m_latency.updates) || (delay_us < m_latency.min_us))
+    {
+        m_latency.min_us = delay_us;
+    }
+    if (delay_us > m_latency.max_us)
+    {
+        m_latency.max_us = delay_us;
+    }
+    m_latency.last_us = delay_us;
+    m_latency.total_us += delay_us;
+    m_latency.updates++;
+}
+
+/**@brief Handles radio notifications, called RADIO_NOTIFICATION_DISTANCE ahead of each radio
+ *        event and again once it is over.
+ *
+ * @details Committing the pending payload right before an advertising event puts it on air in
+ *          this event instead of the next one, independent of the advertising interval. Once the
+ *          event is over, the SoftDevice no longer reads the replaced buffer.
+ *
+ * @param[in]   radio_active    True ahead of a radio event, false after it.
+ */
+static void radio_notification_handler(bool radio_active)
 {
     uint32_t err_code;
-    ble_advdata_t advdata;
-    ble_advdata_t srdata;
-    uint8_t flags = BLE_GAP_ADV_FLAG_BR_EDR_NOT_SUPPORTED;
-    ble_advdata_manuf_data_t manuf_specific_data;
+    uint32_t lead_us = RADIO_NOTIFICATION_DISTANCE_US;
+    uint8_t idx;
 
-    memset(m_beacon_info, 0U, sizeof(m_beacon_info));
-    location_data_serialize(location_data, m_beacon_info, sizeof(m_beacon_info));
+    if (!radio_active)
+    {
+        buffers_release();
+        return;
+    }
 
-    manuf_specific_data.company_identifier = APP_COMPANY_IDENTIFIER;
-    manuf_specific_data.data.p_data = (uint8_t *)m_beacon_info;
-    manuf_specific_data.data.size = APP_BEACON_INFO_LENGTH;
+    idx = m_pending_idx;
+    if (ADV_BUFFER_NONE == idx)
+    {
+        return;
+    }
 
-    // Build and set advertising data.
-    memset(&advdata, 0, sizeof(advdata));
+#if BEACON_CONNECTABLE
+    // While connected the notification may precede a connection event, the time until the next
+    // advertising event is unknown then and not added.
+    if (BLE_CONN_HANDLE_INVALID != m_conn_handle)
+    {
+        lead_us = 0U;
+    }
+#endif
+    payload_commit(idx, lead_us);
+    m_pending_idx = ADV_BUFFER_NONE;
 
-    advdata.name_type = BLE_ADVDATA_NO_NAME;
-    advdata.flags = flags;
-    advdata.p_manuf_specific_data = &manuf_specific_data;
+    err_code = sd_ble_gap_adv_set_configure(&m_adv_handle, &m_adv_data, NULL);
+    APP_ERROR_CHECK(err_code);
+}
 
-    // Build and set scan response data.
-    memset(&srdata, 0, sizeof(srdata));
+/**@brief Claims a buffer for the next update, to be called from the main context only.
+ *
+ * @details A payload still pending is withdrawn and its buffer reused, it already holds the newest
+ *          advertising and scan response data. Otherwise a free buffer is acquired and, with
+ *          telemetry, its scan response is brought up to date from the buffer on air.
+ *
+ * @param[out]  pending     True if the pending payload has been withdrawn.
+ *
+ * @returns Buffer index or ADV_BUFFER_NONE if no buffer is free.
+ */
+static uint8_t buffer_claim(bool *pending)
+{
+    uint8_t idx;
 
-    srdata.name_type = BLE_ADVDATA_SHORT_NAME;
-    srdata.short_name_len = 11U;
+    CRITICAL_REGION_ENTER();
+    idx = m_pending_idx;
+    *pending = (ADV_BUFFER_NONE != idx);
+    if (*pending)
+    {
+        m_pending_idx = ADV_BUFFER_NONE;
+    }
+    else
+    {
+        idx = buffer_acquire();
+    }
+    if (ADV_BUFFER_NONE != idx)
+    {
+        m_buffer_state[idx] = ADV_BUFFER_WRITING;
+    }
+    CRITICAL_REGION_EXIT();
+
+#if SCAN_TELEMETRY
+    // Nothing is pending, so the buffer on air is the newest one and is not replaced meanwhile.
+    if (!*pending && (ADV_BUFFER_NONE != idx))
+    {
+        memcpy(m_enc_srdata[idx], m_enc_srdata[m_on_air_idx], m_adv_data.scan_rsp_data.len);
+    }
+#endif
 
-    m_adv_data.adv_data.p_data = (m_adv_data.adv_data.p_data != m_enc_advdata[0U]) ? m_enc_advdata[0U] : m_enc_advdata[1U];
-    m_adv_data.scan_rsp_data.p_data = (m_adv_data.scan_rsp_data.p_data != m_enc_srdata[0U]) ? m_enc_srdata[0U] : m_enc_srdata[1U];
+    return idx;
+}
 
-    err_code = ble_advdata_encode(&advdata, m_adv_data.adv_data.p_data, &m_adv_data.adv_data.len);
+/**@brief Returns the index of a free buffer or ADV_BUFFER_NONE, to be called within a critical
+ *        region.
+ */
+static uint8_t buffer_acquire(void)
+{
+    for (uint8_t i = 0U; i < BEACON_ADV_BUFFER_COUNT; i++)
+    {
+        if (ADV_BUFFER_FREE == m_buffer_state[i])
+        {
+            return i;
+        }
+    }
+
+    return ADV_BUFFER_NONE;
+}
+
+/**@brief Frees all replaced buffers, to be called within a critical region. */
+static void buffers_release(void)
+{
+    for (uint8_t i = 0U; i < BEACON_ADV_BUFFER_COUNT; i++)
+    {
+        if (ADV_BUFFER_RELEASING == m_buffer_state[i])
+        {
+            m_buffer_state[i] = ADV_BUFFER_FREE;
+        }
+    }
+}
+
+#if SCAN_TELEMETRY
+/**@brief Encodes the current telemetry into the scan response of a new buffer.
+ *
+ * @details Scan requests only arrive while advertising, so the buffer is always committed by the
+ *          radio notification. Without a pending payload, the advertising data on air is copied,
+ *          so the buffer goes on air with the same beacon information. If no buffer is free, the
+ *          refresh is skipped until the next scan request.
+ */
+static void telemetry_refresh(void)
+{
+    bool pending;
+    uint8_t idx;
+
+    idx = buffer_claim(&pending);
+    if (ADV_BUFFER_NONE == idx)
+    {
+        return;
+    }
+
+    if (!pending)
+    {
+        memcpy(m_enc_advdata[idx], m_enc_advdata[m_on_air_idx], m_adv_data.adv_data.len);
+        m_pending_length = m_adv_data.adv_data.len;
+        m_pending_fix = false;
+    }
+
+    (void)beacon_telemetry_encode(&m_enc_srdata[idx][m_telemetry_offset], BEACON_TELEMETRY_LENGTH);
+
+    CRITICAL_REGION_ENTER();
+    m_buffer_state[idx] = ADV_BUFFER_PENDING;
+    m_pending_idx = idx;
+    CRITICAL_REGION_EXIT();
+}
+#endif
+
+/**@brief Passes the updated advertising data to the stack.
+ *
+ * @details The stack accepts new advertising parameters only while the advertising set is
+ *          stopped. On an interval change the set is stopped, reconfigured with the new data and
+ *          parameters and restarted right away, keeping its handle. Otherwise only the data is
+ *          updated while advertising continues.
+ *
+ * @param[in]   interval    Advertising interval in units of 0.625 ms.
+ */
+static void advertising_update(uint32_t interval)
+{
+    uint32_t err_code;
+
+    if (interval == m_adv_params.interval)
+    {
+        err_code = sd_ble_gap_adv_set_configure(&m_adv_handle, &m_adv_data, NULL);
+        APP_ERROR_CHECK(err_code);
+        return;
+    }
+
+    // A connection may change the advertising type meanwhile.
+    CRITICAL_REGION_ENTER();
+    if (m_advertising)
+    {
+        err_code = sd_ble_gap_adv_stop(m_adv_handle);
+        APP_ERROR_CHECK(err_code);
+    }
+
+    m_adv_params.interval = interval;
+    err_code = sd_ble_gap_adv_set_configure(&m_adv_handle, &m_adv_data, &m_adv_params);
     APP_ERROR_CHECK(err_code);
 
-    err_code = ble_advdata_encode(&srdata, m_adv_data.scan_rsp_data.p_data, &m_adv_data.scan_rsp_data.len);
+    if (m_advertising)
+    {
+        err_code = sd_ble_gap_adv_start(m_adv_handle, APP_BLE_CONN_CFG_TAG);
+        APP_ERROR_CHECK(err_code);
+    }
+    CRITICAL_REGION_EXIT();
+}
+
+#if BEACON_CONNECTABLE
+/**@brief Switches the type of the advertising set.
+ *
+ * @details The stack allows a single advertising set. It is connectable while no central is
+ *          connected. A connection ends connectable advertising, the set is then restarted as
+ *          non-connectable, so the Beacon keeps advertising its location alongside the
+ *          connection.
+ *
+ * @param[in]   type    Advertising type.
+ * @param[in]   stop    Advertising needs to be stopped first.
+ */
+static void advertising_type_set(uint8_t type, bool stop)
+{
+    uint32_t err_code;
+
+    CRITICAL_REGION_ENTER();
+    if (stop && m_advertising)
+    {
+        err_code = sd_ble_gap_adv_stop(m_adv_handle);
+        APP_ERROR_CHECK(err_code);
+    }
+
+    m_adv_params.properties.type = type;
+    err_code = sd_ble_gap_adv_set_configure(&m_adv_handle, &m_adv_data, &m_adv_params);
     APP_ERROR_CHECK(err_code);
 
-    err_code = sd_ble_gap_adv_set_configure(&m_adv_handle, &m_adv_data, NULL);
+    if (m_advertising)
+    {
+        err_code = sd_ble_gap_adv_start(m_adv_handle, APP_BLE_CONN_CFG_TAG);
+        APP_ERROR_CHECK(err_code);
+    }
+    CRITICAL_REGION_EXIT();
+}
+#endif
+
+#if BEACON_CONNECTABLE || SCAN_TELEMETRY
+/**@brief Handles BLE stack events of the connection and scan request reports. */
+static void ble_evt_handler(ble_evt_t const *p_ble_evt, void *p_context)
+{
+    uint32_t err_code = NRF_SUCCESS;
+
+    UNUSED_PARAMETER(p_context);
+
+    switch (p_ble_evt->header.evt_id)
+    {
+#if SCAN_TELEMETRY
+    case BLE_GAP_EVT_SCAN_REQ_REPORT:
+        // A scanner is reading the scan response, the main loop refreshes the telemetry.
+        m_scan_requested = true;
+        break;
+#endif
+
+#if BEACON_CONNECTABLE
+    case BLE_GAP_EVT_CONNECTED:
+        m_conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
+        advertising_type_set(ADV_TYPE_NONCONNECTABLE, false);
+        m_phy_update_pending = true;
+        phy_update_request();
+        break;
+
+    case BLE_GAP_EVT_DATA_LENGTH_UPDATE:
+        // The data length procedure started by the GATT module is over.
+        phy_update_request();
+        break;
+
+    case BLE_GAP_EVT_DISCONNECTED:
+        m_conn_handle = BLE_CONN_HANDLE_INVALID;
+        advertising_type_set(ADV_TYPE_CONNECTABLE, true);
+        break;
+
+    case BLE_GAP_EVT_PHY_UPDATE_REQUEST:
+    {
+        ble_gap_phys_t const phys =
+        {
+            .rx_phys = BLE_GAP_PHY_AUTO,
+            .tx_phys = BLE_GAP_PHY_AUTO,
+        };
+        err_code = sd_ble_gap_phy_update(p_ble_evt->evt.gap_evt.conn_handle, &phys);
+    } break;
+
+    case BLE_GAP_EVT_SEC_PARAMS_REQUEST:
+        // Pairing not supported, the location is public anyway.
+        err_code = sd_ble_gap_sec_params_reply(m_conn_handle, BLE_GAP_SEC_STATUS_PAIRING_NOT_SUPP, NULL, NULL);
+        break;
+
+    case BLE_GATTS_EVT_SYS_ATTR_MISSING:
+        // No system attributes have been stored.
+        err_code = sd_ble_gatts_sys_attr_set(m_conn_handle, NULL, 0, 0);
+        break;
+
+    case BLE_GATTC_EVT_TIMEOUT:
+        err_code = sd_ble_gap_disconnect(p_ble_evt->evt.gattc_evt.conn_handle,
+                                         BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
+        break;
+
+    case BLE_GATTS_EVT_TIMEOUT:
+        err_code = sd_ble_gap_disconnect(p_ble_evt->evt.gatts_evt.conn_handle,
+                                         BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
+        break;
+#endif
+
+    default:
+        break;
+    }
+
     APP_ERROR_CHECK(err_code);
 }
+#endif
+
+#if BEACON_CONNECTABLE
+
+/**@brief Requests the 2M PHY for the track download, the central may reject it.
+ *
+ * @details Only one link layer procedure runs at a time, so the request is repeated after the
+ *          data length update if the stack is busy.
+ */
+static void phy_update_request(void)
+{
+    uint32_t err_code;
+    ble_gap_phys_t const phys =
+    {
+        .rx_phys = BLE_GAP_PHY_2MBPS,
+        .tx_phys = BLE_GAP_PHY_2MBPS,
+    };
+
+    if (!m_phy_update_pending)
+    {
+        return;
+    }
+
+    err_code = sd_ble_gap_phy_update(m_conn_handle, &phys);
+    if (NRF_ERROR_BUSY != err_code)
+    {
+        APP_ERROR_CHECK(err_code);
+        m_phy_update_pending = false;
+    }
+}
+
+/**@brief Function for initializing the GATT module.
+ *
+ * @details The GATT module negotiates the large ATT MTU and data length extension with the
+ *          central after connecting.
+ */
+static void gatt_init(void)
+{
+    ret_code_t err_code;
+
+    err_code = nrf_ble_gatt_init(&m_gatt, NULL);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = nrf_ble_gatt_att_mtu_periph_set(&m_gatt, NRF_SDH_BLE_GATT_MAX_MTU_SIZE);
+    APP_ERROR_CHECK(err_code);
+}
+#endif
 
 /**@brief Function for initializing the Advertising functionality.
  *
  * @details Encodes the required advertising data and passes it to the stack.
  *          Also builds a structure to be passed to the stack when starting advertising.
+ *          Advertising and scan response data are encoded once into all buffers, updates
+ *          only overwrite the beacon information at m_beacon_info_offset and the telemetry at
+ *          m_telemetry_offset.
+ *          The manufacturer specific data is encoded separately after all other AD structures,
+ *          as the encoder puts the device name last, so the track payload can grow into the
+ *          remaining space.
+ *          In extended mode the beacon advertises non-scannable on the configured PHYs, so the
+ *          device name is part of the advertising data instead of the scan response.
+ *          In connectable mode the Location and Navigation Service UUID is advertised as well.
  */
 static void advertising_init(void)
 {
     uint32_t err_code;
+    uint16_t length;
     ble_advdata_t advdata;
+    ble_advdata_t manufdata;
+#if (BEACON_ADV_MODE == BEACON_ADV_LEGACY)
     ble_advdata_t srdata;
+#endif
+#if SCAN_TELEMETRY
+    ble_advdata_manuf_data_t telemetry_data;
+#endif
+#if BEACON_CONNECTABLE
+    uint8_t flags = BLE_GAP_ADV_FLAGS_LE_ONLY_GENERAL_DISC_MODE;
+    ble_uuid_t adv_uuids[] = {{BLE_UUID_LOCATION_NAVIGATION_SERVICE, BLE_UUID_TYPE_BLE}};
+#else
     uint8_t flags = BLE_GAP_ADV_FLAG_BR_EDR_NOT_SUPPORTED;
+#endif
     ble_advdata_manuf_data_t manuf_specific_data;
 
+    m_sequence = 0U;
+    beacon_track_init(&m_track);
+    m_fix_ticks = 0U;
+    m_last_fix_cnt = app_timer_cnt_get();
+    m_fix_count = 0UL;
+    m_encoded_fix_count = 0UL;
+    advertising_policy_init();
+#if (BEACON_PAYLOAD_FORMAT == BEACON_PAYLOAD_SECURE)
+    beacon_crypto_init();
+#endif
+    (void)beacon_payload_encode(&m_track, m_sequence, m_beacon_info, APP_BEACON_INFO_LENGTH);
+
     manuf_specific_data.company_identifier = APP_COMPANY_IDENTIFIER;
     manuf_specific_data.data.p_data = (uint8_t *)m_beacon_info;
     manuf_specific_data.data.size = APP_BEACON_INFO_LENGTH;
@@ -165,20 +805,49 @@ static void advertising_init(void)
     // Build and set advertising data.
     memset(&advdata, 0, sizeof(advdata));
 
-    advdata.name_type = BLE_ADVDATA_NO_NAME;
     advdata.flags = flags;
-    advdata.p_manuf_specific_data = &manuf_specific_data;
+
+    memset(&manufdata, 0, sizeof(manufdata));
+
+    manufdata.name_type = BLE_ADVDATA_NO_NAME;
+    manufdata.p_manuf_specific_data = &manuf_specific_data;
+
+#if (BEACON_ADV_MODE == BEACON_ADV_LEGACY)
+    advdata.name_type = BLE_ADVDATA_NO_NAME;
 
     // Build and set scan response data.
     memset(&srdata, 0, sizeof(srdata));
 
     srdata.name_type = BLE_ADVDATA_SHORT_NAME;
     srdata.short_name_len = 11U;
+#if BEACON_CONNECTABLE
+    srdata.uuids_complete.uuid_cnt = ARRAY_SIZE(adv_uuids);
+    srdata.uuids_complete.p_uuids = adv_uuids;
+#endif
+#else
+    advdata.name_type = BLE_ADVDATA_SHORT_NAME;
+    advdata.short_name_len = 11U;
+#if BEACON_CONNECTABLE
+    advdata.uuids_complete.uuid_cnt = ARRAY_SIZE(adv_uuids);
+    advdata.uuids_complete.p_uuids = adv_uuids;
+#endif
+#endif
 
     // Initialize advertising parameters (used when starting advertising).
     memset(&m_adv_params, 0, sizeof(m_adv_params));
 
-    m_adv_params.properties.type = BLE_GAP_ADV_TYPE_NONCONNECTABLE_SCANNABLE_UNDIRECTED;
+#if BEACON_CONNECTABLE
+    m_adv_params.properties.type = ADV_TYPE_CONNECTABLE;
+#else
+    m_adv_params.properties.type = ADV_TYPE_NONCONNECTABLE;
+#endif
+#if (BEACON_ADV_MODE == BEACON_ADV_EXTENDED)
+    m_adv_params.primary_phy = BEACON_ADV_PRIMARY_PHY;
+    m_adv_params.secondary_phy = BEACON_ADV_SECONDARY_PHY;
+#endif
+#if SCAN_TELEMETRY
+    m_adv_params.scan_req_notification = 1U;
+#endif
     m_adv_params.p_peer_addr = NULL; // Undirected advertisement.
     m_adv_params.filter_policy = BLE_GAP_ADV_FP_ANY;
     m_adv_params.interval = NON_CONNECTABLE_ADV_INTERVAL;
@@ -187,9 +856,47 @@ static void advertising_init(void)
     err_code = ble_advdata_encode(&advdata, m_adv_data.adv_data.p_data, &m_adv_data.adv_data.len);
     APP_ERROR_CHECK(err_code);
 
+    length = BEACON_ADV_DATA_SIZE_MAX - m_adv_data.adv_data.len;
+    err_code = ble_advdata_encode(&manufdata, &m_adv_data.adv_data.p_data[m_adv_data.adv_data.len], &length);
+    APP_ERROR_CHECK(err_code);
+    m_adv_data.adv_data.len += length;
+
+#if (BEACON_ADV_MODE == BEACON_ADV_LEGACY)
     err_code = ble_advdata_encode(&srdata, m_adv_data.scan_rsp_data.p_data, &m_adv_data.scan_rsp_data.len);
     APP_ERROR_CHECK(err_code);
 
+#if SCAN_TELEMETRY
+    telemetry_data.company_identifier = APP_COMPANY_IDENTIFIER;
+    telemetry_data.data.p_data = m_telemetry;
+    telemetry_data.data.size = beacon_telemetry_encode(m_telemetry, BEACON_TELEMETRY_LENGTH);
+    manufdata.p_manuf_specific_data = &telemetry_data;
+
+    length = BLE_GAP_ADV_SET_DATA_SIZE_MAX - m_adv_data.scan_rsp_data.len;
+    err_code = ble_advdata_encode(&manufdata, &m_adv_data.scan_rsp_data.p_data[m_adv_data.scan_rsp_data.len], &length);
+    APP_ERROR_CHECK(err_code);
+    m_adv_data.scan_rsp_data.len += length;
+
+    m_telemetry_offset = m_adv_data.scan_rsp_data.len - BEACON_TELEMETRY_LENGTH;
+    m_telemetry_cnt = app_timer_cnt_get();
+#endif
+
+    for (uint8_t i = 1U; i < BEACON_ADV_BUFFER_COUNT; i++)
+    {
+        memcpy(m_enc_srdata[i], m_enc_srdata[0U], m_adv_data.scan_rsp_data.len);
+    }
+#endif
+
+    m_beacon_info_offset = m_adv_data.adv_data.len - APP_BEACON_INFO_LENGTH;
+    m_beacon_info_capacity = BEACON_ADV_DATA_SIZE_MAX - m_beacon_info_offset;
+
+    m_buffer_state[0U] = ADV_BUFFER_ON_AIR;
+    m_on_air_idx = 0U;
+    for (uint8_t i = 1U; i < BEACON_ADV_BUFFER_COUNT; i++)
+    {
+        memcpy(m_enc_advdata[i], m_enc_advdata[0U], m_adv_data.adv_data.len);
+        m_buffer_state[i] = ADV_BUFFER_FREE;
+    }
+
     err_code = sd_ble_gap_adv_set_configure(&m_adv_handle, &m_adv_data, &m_adv_params);
     APP_ERROR_CHECK(err_code);
 }
@@ -211,9 +918,35 @@ static void ble_stack_init(void)
     err_code = nrf_sdh_ble_default_cfg_set(APP_BLE_CONN_CFG_TAG, &ram_start);
     APP_ERROR_CHECK(err_code);
 
+#if BEACON_CONNECTABLE
+    // Queue enough notifications to fill long connection events.
+    ble_cfg_t ble_cfg;
+
+    memset(&ble_cfg, 0, sizeof(ble_cfg));
+    ble_cfg.conn_cfg.conn_cfg_tag = APP_BLE_CONN_CFG_TAG;
+    ble_cfg.conn_cfg.params.gatts_conn_cfg.hvn_tx_queue_size = HVN_TX_QUEUE_SIZE;
+    err_code = sd_ble_cfg_set(BLE_CONN_CFG_GATTS, &ble_cfg, ram_start);
+    APP_ERROR_CHECK(err_code);
+#endif
+
     // Enable BLE stack.
     err_code = nrf_sdh_ble_enable(&ram_start);
     APP_ERROR_CHECK(err_code);
+
+#if BEACON_CONNECTABLE
+    // Extend connection events while there are packets to send and no other radio activity.
+    ble_opt_t ble_opt;
+
+    memset(&ble_opt, 0, sizeof(ble_opt));
+    ble_opt.common_opt.conn_evt_ext.enable = 1U;
+    err_code = sd_ble_opt_set(BLE_COMMON_OPT_CONN_EVT_EXT, &ble_opt);
+    APP_ERROR_CHECK(err_code);
+#endif
+
+#if BEACON_CONNECTABLE || SCAN_TELEMETRY
+    // Register a handler for BLE events.
+    NRF_SDH_BLE_OBSERVER(m_ble_observer, APP_BLE_OBSERVER_PRIO, ble_evt_handler, NULL);
+#endif
 }
 
 /**@brief Function for initializing GAP parameters.
@@ -230,4 +963,42 @@ static void gap_params_init(void)
                                           (const uint8_t *)DEVICE_NAME,
                                           strlen(DEVICE_NAME));
     APP_ERROR_CHECK(err_code);
+
+#if BEACON_CONNECTABLE
+    ble_gap_conn_params_t gap_conn_params;
+
+    memset(&gap_conn_params, 0, sizeof(gap_conn_params));
+
+    gap_conn_params.min_conn_interval = MIN_CONN_INTERVAL;
+    gap_conn_params.max_conn_interval = MAX_CONN_INTERVAL;
+    gap_conn_params.slave_latency     = SLAVE_LATENCY;
+    gap_conn_params.conn_sup_timeout  = CONN_SUP_TIMEOUT;
+
+    err_code = sd_ble_gap_ppcp_set(&gap_conn_params);
+    APP_ERROR_CHECK(err_code);
+#endif
 }
+
+/**@brief Returns the time of a fix in BEACON_TRACK_TIME_UNIT_MS.
+ *
+ * @details The 24 bit app_timer counter is extended to 64 bit, so fix times stay monotonic as
+ *          long as fixes arrive at least once per counter period. The counter value is the
+ *          receive time of the fix, so the fix-to-air delay includes UART ingest, the dispatch
+ *          queue and a minimum interval holding the fix back.
+ *
+ * @param[in]   cnt     app_timer counter value when the fix was received.
+ */
+static uint32_t fix_time_get(uint32_t cnt)
+{
+    uint32_t ticks = app_timer_cnt_diff_compute(cnt, m_last_fix_cnt);
+
+    // A fix received before init would otherwise appear almost a counter period later
+    if (ticks > (APP_TIMER_MAX_CNT_VAL / 2U))
+    {
+        ticks = 0U;
+    }
+    m_fix_ticks += ticks;
+    m_last_fix_cnt = cnt;
+
+    return (uint32_t)((m_fix_ticks * 1000U) / (APP_TIMER_TICK_FREQ * BEACON_TRACK_TIME_UNIT_MS));
+}
\ No newline at end of file
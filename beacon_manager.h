@@ -3,7 +3,27 @@
 
 #include <stdint.h>
 
+/**@brief Delay from accepting a fix until its payload goes on air. */
+typedef struct BeaconLatency
+{
+    uint32_t updates;       /**< Number of payloads passed to the stack. */
+    uint32_t min_us;
+    uint32_t max_us;
+    uint32_t last_us;
+    uint64_t total_us;      /**< Sum of all delays, divided by updates gives the mean delay. */
+} BeaconLatencyType;
+
+/**@brief Advertising updates not passed to the stack. */
+typedef struct BeaconBufferStats
+{
+    uint32_t coalesced;     /**< Payloads replaced by a newer one before going on air. */
+    uint32_t dropped;       /**< Updates without a free advertising buffer. */
+} BeaconBufferStatsType;
+
 void beacon_manager_init(void);
 void beacon_advertising_start(void);
+void beacon_manager_update(void);
+void beacon_manager_latency_get(BeaconLatencyType *latency);
+void beacon_manager_buffer_stats_get(BeaconBufferStatsType *stats);
 
 #endif // BEACON_MANAGER_H__
\ No newline at end of file
@@ -0,0 +1,215 @@
+#include <stddef.h>
+#include "beacon_payload.h"
+#include "beacon_crypto.h"
+
+#define OFFSET_VERSION      0U
+#define OFFSET_FLAGS        1U
+#define OFFSET_SEQUENCE     2U
+#define OFFSET_LATITUDE     3U
+#define OFFSET_LONGITUDE    7U
+
+#define OFFSET_TRACK_COUNT      3U
+#define OFFSET_TRACK_LATITUDE   4U
+#define OFFSET_TRACK_LONGITUDE  8U
+
+#define OFFSET_SECURE_NONCE     1U
+#define OFFSET_SECURE_DATA      9U      /**< Flags, latitude and longitude, encrypted. */
+#define OFFSET_SECURE_MAC       18U
+#define SECURE_DATA_LENGTH      (OFFSET_SECURE_MAC - OFFSET_SECURE_DATA)
+
+// Private method declarations
+#if (BEACON_PAYLOAD_FORMAT == BEACON_PAYLOAD_TRACK)
+static uint8_t track_encode(const BeaconTrackType *track, uint8_t *buffer, uint8_t capacity);
+static uint8_t varint_length(uint32_t value);
+static uint8_t varint_write(uint8_t *buffer, uint32_t value);
+static uint32_t zigzag_encode(int32_t value);
+#endif
+#if (BEACON_PAYLOAD_FORMAT != BEACON_PAYLOAD_ASCII)
+static void write_u32(uint8_t *buffer, uint32_t value);
+#endif
+
+/*
+ * Public methods
+ */
+
+/**@brief Clears the track. */
+void beacon_track_init(BeaconTrackType *track)
+{
+    track->newest = 0U;
+    track->count = 0U;
+}
+
+/**@brief Adds a fix to the track, the oldest fix is overwritten once the track is full.
+ *
+ * @param[in]   track       Track.
+ * @param[in]   location    Location of the fix.
+ * @param[in]   time        Time of the fix in BEACON_TRACK_TIME_UNIT_MS.
+ */
+void beacon_track_add(BeaconTrackType *track, const LocationDataType *location, uint32_t time)
+{
+    if (track->count > 0U)
+    {
+        track->newest = (track->newest + 1U) & (BEACON_TRACK_SIZE - 1U);
+    }
+    if (track->count < BEACON_TRACK_SIZE)
+    {
+        ++track->count;
+    }
+
+    track->fix[track->newest].location = *location;
+    track->fix[track->newest].time = time;
+}
+
+/**@brief Encodes the beacon payload in the format selected by BEACON_PAYLOAD_FORMAT.
+ *
+ * @details ASCII, binary and secure format only carry the newest fix. The track format carries
+ *          as many recent fixes as fit into the given capacity. The secure format encrypts and
+ *          authenticates the binary fields with the next nonce of the crypto module.
+ *
+ * @param[in]   track       Recent fixes, empty if there is no fix yet.
+ * @param[in]   sequence    Sequence counter, not used by the ASCII format.
+ * @param[out]  buffer      Payload buffer.
+ * @param[in]   capacity    Size of the payload buffer, at least BEACON_PAYLOAD_LENGTH.
+ *
+ * @returns Length of the encoded payload.
+ */
+uint8_t beacon_payload_encode(const BeaconTrackType *track, uint8_t sequence, uint8_t *buffer, uint8_t capacity)
+{
+    LocationDataType location;
+    bool fix_valid = (track->count > 0U);
+
+    if (fix_valid)
+    {
+        location = track->fix[track->newest].location;
+    }
+    else
+    {
+        location_data_init(&location);
+    }
+
+#if (BEACON_PAYLOAD_FORMAT == BEACON_PAYLOAD_ASCII)
+    (void)sequence;
+    (void)fix_valid;
+    location_data_serialize(&location, buffer, capacity);
+
+    return BEACON_PAYLOAD_ASCII_LENGTH;
+#elif (BEACON_PAYLOAD_FORMAT == BEACON_PAYLOAD_SECURE)
+    uint8_t *data = &buffer[OFFSET_SECURE_DATA];
+
+    (void)sequence;
+    (void)capacity;
+    buffer[OFFSET_VERSION] = BEACON_PAYLOAD_VERSION_SECURE;
+    beacon_crypto_nonce_next(&buffer[OFFSET_SECURE_NONCE]);
+
+    data[0U] = fix_valid ? BEACON_PAYLOAD_FLAG_FIX_VALID : 0U;
+    write_u32(&data[1U], (uint32_t)location.latitude);
+    write_u32(&data[5U], (uint32_t)location.longitude);
+
+    beacon_crypto_ctr(&buffer[OFFSET_SECURE_NONCE], data, SECURE_DATA_LENGTH);
+    beacon_crypto_mac(buffer, OFFSET_SECURE_MAC, &buffer[OFFSET_SECURE_MAC]);
+
+    return BEACON_PAYLOAD_SECURE_LENGTH;
+#else
+    buffer[OFFSET_FLAGS]    = fix_valid ? BEACON_PAYLOAD_FLAG_FIX_VALID : 0U;
+    buffer[OFFSET_SEQUENCE] = sequence;
+
+#if (BEACON_PAYLOAD_FORMAT == BEACON_PAYLOAD_TRACK)
+    buffer[OFFSET_VERSION] = BEACON_PAYLOAD_VERSION_TRACK;
+    write_u32(&buffer[OFFSET_TRACK_LATITUDE], (uint32_t)location.latitude);
+    write_u32(&buffer[OFFSET_TRACK_LONGITUDE], (uint32_t)location.longitude);
+
+    return track_encode(track, buffer, capacity);
+#else
+    (void)capacity;
+    buffer[OFFSET_VERSION] = BEACON_PAYLOAD_VERSION;
+    write_u32(&buffer[OFFSET_LATITUDE], (uint32_t)location.latitude);
+    write_u32(&buffer[OFFSET_LONGITUDE], (uint32_t)location.longitude);
+
+    return BEACON_PAYLOAD_BINARY_LENGTH;
+#endif
+#endif
+}
+
+/*
+ * Private methods
+ */
+
+#if (BEACON_PAYLOAD_FORMAT == BEACON_PAYLOAD_TRACK)
+/**@brief Appends the older fixes of the track as long as they fit into the capacity. */
+static uint8_t track_encode(const BeaconTrackType *track, uint8_t *buffer, uint8_t capacity)
+{
+    uint8_t length = BEACON_PAYLOAD_TRACK_HEADER_LENGTH;
+    uint8_t count = (track->count > 0U) ? 1U : 0U;
+    uint8_t newer = track->newest;
+
+    while (count < track->count)
+    {
+        uint8_t older = (newer - 1U) & (BEACON_TRACK_SIZE - 1U);
+        const BeaconFixType * newer_fix = &track->fix[newer];
+        const BeaconFixType * older_fix = &track->fix[older];
+        uint32_t delta_latitude = zigzag_encode(newer_fix->location.latitude - older_fix->location.latitude);
+        uint32_t delta_longitude = zigzag_encode(newer_fix->location.longitude - older_fix->location.longitude);
+        uint32_t delta_time = newer_fix->time - older_fix->time;
+
+        if ((length + varint_length(delta_latitude) + varint_length(delta_longitude) +
+             varint_length(delta_time)) > capacity)
+        {
+            break;
+        }
+
+        length += varint_write(&buffer[length], delta_latitude);
+        length += varint_write(&buffer[length], delta_longitude);
+        length += varint_write(&buffer[length], delta_time);
+
+        newer = older;
+        ++count;
+    }
+
+    buffer[OFFSET_TRACK_COUNT] = count;
+
+    return length;
+}
+
+static uint8_t varint_length(uint32_t value)
+{
+    uint8_t length = 1U;
+
+    while (value >= 0x80UL)
+    {
+        value >>= 7;
+        ++length;
+    }
+
+    return length;
+}
+
+static uint8_t varint_write(uint8_t *buffer, uint32_t value)
+{
+    uint8_t length = 0U;
+
+    while (value >= 0x80UL)
+    {
+        buffer[length++] = (uint8_t)value | 0x80U;
+        value >>= 7;
+    }
+    buffer[length++] = (uint8_t)value;
+
+    return length;
+}
+
+/**@brief Maps signed to unsigned values, so small differences of either sign give short varints. */
+static uint32_t zigzag_encode(int32_t value)
+{
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+#endif
+
+#if (BEACON_PAYLOAD_FORMAT != BEACON_PAYLOAD_ASCII)
+static void write_u32(uint8_t *buffer, uint32_t value)
+{
+    buffer[0U] = (uint8_t)value;
+    buffer[1U] = (uint8_t)(value >> 8);
+    buffer[2U] = (uint8_t)(value >> 16);
+    buffer[3U] = (uint8_t)(value >> 24);
+}
+#endif
\ No newline at end of file
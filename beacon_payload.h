@@ -0,0 +1,109 @@
+#ifndef BEACON_PAYLOAD_H__
+#define BEACON_PAYLOAD_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "location_data.h"
+
+#define BEACON_PAYLOAD_ASCII            0   /**< "+dd.dddddd,+ddd.dddddd", readable in any scanner app. */
+#define BEACON_PAYLOAD_BINARY           1   /**< Versioned little endian binary format, see below. */
+#define BEACON_PAYLOAD_TRACK            2   /**< Binary format carrying the recent track, see below. */
+#define BEACON_PAYLOAD_SECURE           3   /**< Encrypted and authenticated binary format, see below. */
+
+#ifndef BEACON_PAYLOAD_FORMAT
+#define BEACON_PAYLOAD_FORMAT           BEACON_PAYLOAD_ASCII    /**< Format of the advertised manufacturer data. */
+#endif
+
+/* Binary format version 1, all values little endian:
+ *
+ * | Offset | Size | Content                                         |
+ * |--------|------|-------------------------------------------------|
+ * | 0      | 1    | Version, BEACON_PAYLOAD_VERSION                 |
+ * | 1      | 1    | Flags, BEACON_PAYLOAD_FLAG_*                    |
+ * | 2      | 1    | Sequence counter, incremented with every update |
+ * | 3      | 4    | Latitude in micro-degrees, int32                |
+ * | 7      | 4    | Longitude in micro-degrees, int32               |
+ *
+ * The version byte never collides with the first character of the ASCII format ('+' or '-').
+ * Later versions append fields, e.g. altitude and speed, so decoders of version 1 can read the
+ * leading fields of any version.
+ *
+ * Track format, version BEACON_PAYLOAD_VERSION_TRACK:
+ *
+ * | Offset | Size | Content                                           |
+ * |--------|------|---------------------------------------------------|
+ * | 0      | 1    | Version, BEACON_PAYLOAD_VERSION_TRACK             |
+ * | 1      | 1    | Flags, BEACON_PAYLOAD_FLAG_*                      |
+ * | 2      | 1    | Sequence counter, incremented with every update   |
+ * | 3      | 1    | Number of fixes N including the anchor            |
+ * | 4      | 4    | Anchor latitude, newest fix, int32 micro-degrees  |
+ * | 8      | 4    | Anchor longitude, newest fix, int32 micro-degrees |
+ * | 12     | var  | N - 1 older fixes, newest first                   |
+ *
+ * Each older fix is given relative to the next newer one as three varints (7 bits per byte,
+ * least significant group first, MSB set if more bytes follow): zig-zag encoded latitude
+ * difference, zig-zag encoded longitude difference and time difference in
+ * BEACON_TRACK_TIME_UNIT_MS. The number of fixes is chosen to fill the available space.
+ *
+ * Secure format, version BEACON_PAYLOAD_VERSION_SECURE:
+ *
+ * | Offset | Size | Content                                               |
+ * |--------|------|-------------------------------------------------------|
+ * | 0      | 1    | Version, BEACON_PAYLOAD_VERSION_SECURE                |
+ * | 1      | 4    | Boot identifier, random                               |
+ * | 5      | 4    | Message counter, uint32, incremented with every update |
+ * | 9      | 1    | Flags, encrypted                                      |
+ * | 10     | 4    | Latitude in micro-degrees, int32, encrypted           |
+ * | 14     | 4    | Longitude in micro-degrees, int32, encrypted          |
+ * | 18     | 4    | AES-CMAC of bytes 0 to 17, truncated                  |
+ *
+ * Boot identifier and message counter form the nonce of the AES-CTR encryption, see
+ * beacon_crypto.c. Encryption and CMAC use keys derived from BEACON_CRYPTO_KEY. Scanners
+ * should reject counters not above the last one received from the same boot identifier.
+ */
+#define BEACON_PAYLOAD_VERSION          0x01U
+#define BEACON_PAYLOAD_VERSION_TRACK    0x02U
+#define BEACON_PAYLOAD_VERSION_SECURE   0x03U
+#define BEACON_PAYLOAD_FLAG_FIX_VALID   0x01U   /**< Position is a valid fix. */
+
+#define BEACON_PAYLOAD_ASCII_LENGTH     (LATITUDE_MAX_DATA_SIZE + LONGITUDE_MAX_DATA_SIZE + 1U)
+#define BEACON_PAYLOAD_BINARY_LENGTH    11U
+#define BEACON_PAYLOAD_TRACK_HEADER_LENGTH  12U
+#define BEACON_PAYLOAD_SECURE_LENGTH    22U
+
+#define BEACON_TRACK_TIME_UNIT_MS       10U     /**< Resolution of fix times in the track format. */
+
+#if (BEACON_PAYLOAD_FORMAT == BEACON_PAYLOAD_TRACK)
+#define BEACON_PAYLOAD_LENGTH           BEACON_PAYLOAD_TRACK_HEADER_LENGTH  /**< Minimum length, grows with the track. */
+#define BEACON_TRACK_SIZE               64U     /**< Number of recent fixes kept, must be a power of two. */
+#elif (BEACON_PAYLOAD_FORMAT == BEACON_PAYLOAD_SECURE)
+#define BEACON_PAYLOAD_LENGTH           BEACON_PAYLOAD_SECURE_LENGTH
+#define BEACON_TRACK_SIZE               1U
+#elif (BEACON_PAYLOAD_FORMAT == BEACON_PAYLOAD_BINARY)
+#define BEACON_PAYLOAD_LENGTH           BEACON_PAYLOAD_BINARY_LENGTH
+#define BEACON_TRACK_SIZE               1U
+#else
+#define BEACON_PAYLOAD_LENGTH           BEACON_PAYLOAD_ASCII_LENGTH
+#define BEACON_TRACK_SIZE               1U
+#endif
+
+/**@brief Fix with the time it was received. */
+typedef struct BeaconFix
+{
+    LocationDataType location;
+    uint32_t time;              /**< Time in BEACON_TRACK_TIME_UNIT_MS, wrapping. */
+} BeaconFixType;
+
+/**@brief Recent fixes, kept as ring buffer. */
+typedef struct BeaconTrack
+{
+    BeaconFixType fix[BEACON_TRACK_SIZE];
+    uint8_t newest;             /**< Index of the newest fix. */
+    uint8_t count;              /**< Number of fixes stored. */
+} BeaconTrackType;
+
+void beacon_track_init(BeaconTrackType *track);
+void beacon_track_add(BeaconTrackType *track, const LocationDataType *location, uint32_t time);
+uint8_t beacon_payload_encode(const BeaconTrackType *track, uint8_t sequence, uint8_t *buffer, uint8_t capacity);
+
+#endif // BEACON_PAYLOAD_H__
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include <stddef.h>
+#include "beacon_payload_decode.h"
+#include "location_parser.h"
+
+#define OFFSET_VERSION      0U
+#define OFFSET_FLAGS        1U
+#define OFFSET_SEQUENCE     2U
+#define OFFSET_LATITUDE     3U
+#define OFFSET_LONGITUDE    7U
+
+#define OFFSET_TRACK_COUNT      3U
+#define OFFSET_TRACK_LATITUDE   4U
+#define OFFSET_TRACK_LONGITUDE  8U
+
+#define OFFSET_SECURE_NONCE     1U
+#define OFFSET_SECURE_COUNTER   5U
+#define OFFSET_SECURE_DATA      9U      /**< Flags, latitude and longitude, encrypted. */
+#define OFFSET_SECURE_MAC       18U
+#define SECURE_DATA_LENGTH      (OFFSET_SECURE_MAC - OFFSET_SECURE_DATA)
+
+#define VARINT_MAX_LENGTH   5U      /**< Maximum length of a varint encoded uint32. */
+
+// Private method declarations
+static bool track_decode(const uint8_t *buffer, uint8_t length, BeaconPayloadType *payload);
+static bool secure_decode(const uint8_t *buffer, uint8_t length, const BeaconPayloadCryptoType *crypto,
+                          BeaconPayloadType *payload);
+static uint8_t varint_read(const uint8_t *buffer, uint8_t length, uint32_t *value);
+static int32_t zigzag_decode(uint32_t value);
+static uint32_t read_u32(const uint8_t *buffer);
+
+/*
+ * Public methods
+ */
+
+/**@brief Reference decoder for scanners, accepts all payload formats.
+ *
+ * @details Independent of BEACON_PAYLOAD_FORMAT and of the SoftDevice, so it builds for any
+ *          scanner. Binary payloads are accepted for any version, but only the fields of version 1
+ *          are decoded. ASCII payloads are validated by the location line parser. Track payloads
+ *          are decoded completely. Secure payloads are only accepted with a valid CMAC and are
+ *          rejected if no crypto functions are given.
+ *
+ * @param[in]   buffer      Manufacturer specific data following the company identifier.
+ * @param[in]   length      Length of the data.
+ * @param[in]   crypto      AES functions for the secure format, may be NULL.
+ * @param[out]  payload     Decoded payload.
+ *
+ * @returns true if the payload could be decoded, false otherwise.
+ */
+bool beacon_payload_decode(const uint8_t *buffer, uint8_t length, const BeaconPayloadCryptoType *crypto,
+                           BeaconPayloadType *payload)
+{
+    if ((NULL == buffer) || (NULL == payload) || (0U == length))
+    {
+        return false;
+    }
+
+    payload->fix[0U].time = 0UL;
+
+    if (('+' == buffer[0U]) || ('-' == buffer[0U]))
+    {
+        payload->version  = 0U;
+        payload->flags    = BEACON_PAYLOAD_FLAG_FIX_VALID;
+        payload->sequence = 0U;
+        payload->count    = 1U;
+
+        return (LOCATION_PARSE_SUCCESS == location_parser_parse(buffer, length, &payload->fix[0U].location, NULL));
+    }
+
+    if (BEACON_PAYLOAD_VERSION_TRACK == buffer[OFFSET_VERSION])
+    {
+        return track_decode(buffer, length, payload);
+    }
+
+    if (BEACON_PAYLOAD_VERSION_SECURE == buffer[OFFSET_VERSION])
+    {
+        return secure_decode(buffer, length, crypto, payload);
+    }
+
+    if ((buffer[OFFSET_VERSION] < BEACON_PAYLOAD_VERSION) || (length < BEACON_PAYLOAD_BINARY_LENGTH))
+    {
+        return false;
+    }
+
+    payload->version                  = buffer[OFFSET_VERSION];
+    payload->flags                    = buffer[OFFSET_FLAGS];
+    payload->sequence                 = buffer[OFFSET_SEQUENCE];
+    payload->count                    = 1U;
+    payload->fix[0U].location.latitude  = (int32_t)read_u32(&buffer[OFFSET_LATITUDE]);
+    payload->fix[0U].location.longitude = (int32_t)read_u32(&buffer[OFFSET_LONGITUDE]);
+
+    return true;
+}
+
+/*
+ * Private methods
+ */
+
+static bool track_decode(const uint8_t *buffer, uint8_t length, BeaconPayloadType *payload)
+{
+    uint8_t offset = BEACON_PAYLOAD_TRACK_HEADER_LENGTH;
+    uint8_t count;
+
+    if (length < BEACON_PAYLOAD_TRACK_HEADER_LENGTH)
+    {
+        return false;
+    }
+
+    payload->version  = buffer[OFFSET_VERSION];
+    payload->flags    = buffer[OFFSET_FLAGS];
+    payload->sequence = buffer[OFFSET_SEQUENCE];
+    count             = buffer[OFFSET_TRACK_COUNT];
+    payload->count    = (count > 0U) ? 1U : 0U;
+    payload->fix[0U].location.latitude  = (int32_t)read_u32(&buffer[OFFSET_TRACK_LATITUDE]);
+    payload->fix[0U].location.longitude = (int32_t)read_u32(&buffer[OFFSET_TRACK_LONGITUDE]);
+
+    if (count > BEACON_PAYLOAD_DECODE_FIXES)
+    {
+        return false;
+    }
+
+    while (payload->count < count)
+    {
+        const BeaconFixType * newer_fix = &payload->fix[payload->count - 1U];
+        BeaconFixType * older_fix = &payload->fix[payload->count];
+        uint32_t delta[3U];
+
+        for (uint8_t idx = 0U; idx < 3U; ++idx)
+        {
+            uint8_t read = varint_read(&buffer[offset], length - offset, &delta[idx]);
+            if (0U == read)
+            {
+                return false;
+            }
+            offset += read;
+        }
+
+        older_fix->location.latitude  = newer_fix->location.latitude - zigzag_decode(delta[0U]);
+        older_fix->location.longitude = newer_fix->location.longitude - zigzag_decode(delta[1U]);
+        older_fix->time               = newer_fix->time + delta[2U];
+        ++payload->count;
+    }
+
+    return true;
+}
+
+/**@brief Verifies and decrypts a secure payload. */
+static bool secure_decode(const uint8_t *buffer, uint8_t length, const BeaconPayloadCryptoType *crypto,
+                          BeaconPayloadType *payload)
+{
+    uint8_t data[SECURE_DATA_LENGTH];
+
+    if ((NULL == crypto) || (length < BEACON_PAYLOAD_SECURE_LENGTH) ||
+        !crypto->mac_verify(buffer, OFFSET_SECURE_MAC, &buffer[OFFSET_SECURE_MAC]))
+    {
+        return false;
+    }
+
+    for (uint8_t idx = 0U; idx < SECURE_DATA_LENGTH; ++idx)
+    {
+        data[idx] = buffer[OFFSET_SECURE_DATA + idx];
+    }
+    crypto->ctr(&buffer[OFFSET_SECURE_NONCE], data, SECURE_DATA_LENGTH);
+
+    payload->version  = BEACON_PAYLOAD_VERSION_SECURE;
+    payload->flags    = data[0U];
+    payload->sequence = buffer[OFFSET_SECURE_COUNTER];
+    payload->count    = 1U;
+    payload->fix[0U].location.latitude  = (int32_t)read_u32(&data[1U]);
+    payload->fix[0U].location.longitude = (int32_t)read_u32(&data[5U]);
+
+    return true;
+}
+
+/**@brief Reads a varint, returns the number of bytes read or 0 if it is truncated or too long. */
+static uint8_t varint_read(const uint8_t *buffer, uint8_t length, uint32_t *value)
+{
+    *value = 0UL;
+
+    for (uint8_t idx = 0U; (idx < length) && (idx < VARINT_MAX_LENGTH); ++idx)
+    {
+        *value |= (uint32_t)(buffer[idx] & 0x7FU) << (7U * idx);
+        if (0U == (buffer[idx] & 0x80U))
+        {
+            return idx + 1U;
+        }
+    }
+
+    return 0U;
+}
+
+static int32_t zigzag_decode(uint32_t value)
+{
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1UL);
+}
+
+static uint32_t read_u32(const uint8_t *buffer)
+{
+    return (uint32_t)buffer[0U] | ((uint32_t)buffer[1U] << 8) |
+           ((uint32_t)buffer[2U] << 16) | ((uint32_t)buffer[3U] << 24);
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#ifndef BEACON_PAYLOAD_DECODE_H__
+#define BEACON_PAYLOAD_DECODE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "beacon_payload.h"
+
+// Every older fix of a track payload takes at least three bytes, so any payload fits.
+#define BEACON_PAYLOAD_DECODE_FIXES     (1U + ((UINT8_MAX - BEACON_PAYLOAD_TRACK_HEADER_LENGTH) / 3U))
+
+/**@brief Decoded beacon payload. */
+typedef struct BeaconPayload
+{
+    uint8_t version;            /**< BEACON_PAYLOAD_VERSION*, 0 for ASCII. */
+    uint8_t flags;
+    uint8_t sequence;           /**< Always 0 for ASCII, message counter for the secure format. */
+    uint8_t count;              /**< Number of fixes decoded, newest first. */
+    BeaconFixType fix[BEACON_PAYLOAD_DECODE_FIXES]; /**< Time is the age relative to the newest fix. */
+} BeaconPayloadType;
+
+/**@brief AES functions of the scanner, needed to decode the secure format.
+ *
+ * @details Same semantics as beacon_crypto_ctr() and beacon_crypto_mac_verify(), keyed with the
+ *          keys derived from BEACON_CRYPTO_KEY. On the nRF52840 these two functions can be given
+ *          directly, other scanners provide their own AES implementation.
+ */
+typedef struct BeaconPayloadCrypto
+{
+    void (*ctr)(const uint8_t *nonce, uint8_t *data, uint8_t length);
+    bool (*mac_verify)(const uint8_t *data, uint8_t length, const uint8_t *mac);
+} BeaconPayloadCryptoType;
+
+bool beacon_payload_decode(const uint8_t *buffer, uint8_t length, const BeaconPayloadCryptoType *crypto,
+                           BeaconPayloadType *payload);
+
+#endif // BEACON_PAYLOAD_DECODE_H__
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include <stdbool.h>
+#include "nrf.h"
+#include "app_timer.h"
+#include "app_error.h"
+#include "app_util_platform.h"
+#include "beacon_telemetry.h"
+#include "gnss_handler.h"
+#include "location_service.h"
+
+#define APP_TIMER_TICK_FREQ         (APP_TIMER_CLOCK_FREQ / (APP_TIMER_CONFIG_RTC_FREQUENCY + 1U))
+#define UPTIME_TIMER_INTERVAL       APP_TIMER_TICKS(60000U)     /**< Extends the 24 bit app_timer counter, well within its period. */
+
+#define SUPPLY_SAADC_REFERENCE_MV   600UL   /**< Internal reference of the SAADC. */
+#define SUPPLY_SAADC_GAIN_RECIPROCAL 6UL    /**< Input gain 1/6, full scale is 3.6 V. */
+#define SUPPLY_SAADC_RESOLUTION     4096UL  /**< 12 bit conversion. */
+
+#define OFFSET_FIX_TYPE             0U
+#define OFFSET_SATELLITES           1U
+#define OFFSET_SUPPLY_VOLTAGE       2U
+#define OFFSET_UPTIME               4U
+#define OFFSET_FIXES                8U
+
+APP_TIMER_DEF(uptime_timer);
+
+// Private data
+static int8_t ls_handle;
+static uint16_t fixes;              /**< Fixes received, wraps around. */
+static uint64_t uptime_ticks;       /**< Time since init, extends the app_timer counter. */
+static uint32_t uptime_last_cnt;    /**< app_timer counter at the last uptime update. */
+
+// Private method declarations
+static void telemetry_accept(const LocationDataType *location_data);
+static void uptime_timer_handler(void *p_context);
+static uint32_t uptime_get(void);
+static uint16_t supply_voltage_measure(void);
+
+/*
+ * Public methods
+ */
+
+/**@brief Inits the telemetry module, subscribes to the location service to count fixes. */
+void beacon_telemetry_init(void)
+{
+    ret_code_t err_code;
+
+    fixes = 0U;
+    uptime_ticks = 0U;
+    uptime_last_cnt = app_timer_cnt_get();
+
+    err_code = app_timer_create(&uptime_timer, APP_TIMER_MODE_REPEATED, uptime_timer_handler);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = app_timer_start(uptime_timer, UPTIME_TIMER_INTERVAL, NULL);
+    APP_ERROR_CHECK(err_code);
+
+    ls_handle = location_service_subscribe(&telemetry_accept);
+    if (ls_handle < 0)
+    {
+        // All subscriber slots taken, see MAX_SUBSCRIBERS
+        APP_ERROR_CHECK(NRF_ERROR_NO_MEM);
+    }
+    (void)location_service_priority_set(ls_handle, LOCATION_PRIORITY_LOW);
+}
+
+/**@brief Collects and encodes the current telemetry.
+ *
+ * @details Samples the supply voltage with the SAADC, so call it only when the telemetry is
+ *          actually going to be read, not with every fix.
+ *
+ * @param[out]  buffer      Encoded telemetry, see format above.
+ * @param[in]   capacity    Size of the buffer.
+ *
+ * @returns Length of the encoded telemetry, 0 if the buffer is too small.
+ */
+uint8_t beacon_telemetry_encode(uint8_t *buffer, uint8_t capacity)
+{
+    GnssStatusType status;
+    uint16_t supply_voltage;
+    uint32_t uptime;
+
+    if (capacity < BEACON_TELEMETRY_LENGTH)
+    {
+        return 0U;
+    }
+
+    if (!gnss_handler_status_get(&status))
+    {
+        status.fix_type = BEACON_TELEMETRY_UNKNOWN;
+        status.satellites = BEACON_TELEMETRY_UNKNOWN;
+    }
+    supply_voltage = supply_voltage_measure();
+    uptime = uptime_get();
+
+    buffer[OFFSET_FIX_TYPE]   = status.fix_type;
+    buffer[OFFSET_SATELLITES] = status.satellites;
+    buffer[OFFSET_SUPPLY_VOLTAGE]      = (uint8_t)supply_voltage;
+    buffer[OFFSET_SUPPLY_VOLTAGE + 1U] = (uint8_t)(supply_voltage >> 8);
+    for (uint8_t idx = 0U; idx < 4U; ++idx)
+    {
+        buffer[OFFSET_UPTIME + idx] = (uint8_t)(uptime >> (8U * idx));
+    }
+    buffer[OFFSET_FIXES]      = (uint8_t)fixes;
+    buffer[OFFSET_FIXES + 1U] = (uint8_t)(fixes >> 8);
+
+    return BEACON_TELEMETRY_LENGTH;
+}
+
+/*
+ * Private methods
+ */
+
+/**@brief Subscription function counting the received fixes. */
+static void telemetry_accept(const LocationDataType *location_data)
+{
+    (void)location_data;
+    ++fixes;
+}
+
+/**@brief Keeps the uptime running while neither fixes nor scan requests arrive. */
+static void uptime_timer_handler(void *p_context)
+{
+    (void)p_context;
+    (void)uptime_get();
+}
+
+/**@brief Returns the time since init in s, called from the main loop and the app_timer handler. */
+static uint32_t uptime_get(void)
+{
+    uint32_t uptime;
+
+    CRITICAL_REGION_ENTER();
+    uint32_t cnt = app_timer_cnt_get();
+
+    uptime_ticks += app_timer_cnt_diff_compute(cnt, uptime_last_cnt);
+    uptime_last_cnt = cnt;
+    uptime = (uint32_t)(uptime_ticks / APP_TIMER_TICK_FREQ);
+    CRITICAL_REGION_EXIT();
+
+    return uptime;
+}
+
+/**@brief Measures the supply voltage with a single SAADC conversion of VDD.
+ *
+ * @details The SAADC is only enabled for the conversion, which blocks for about 15 us. It is not
+ *          calibrated, the result is accurate to a few percent.
+ *
+ * @returns Supply voltage in mV.
+ */
+static uint16_t supply_voltage_measure(void)
+{
+    volatile int16_t sample = 0;
+
+    NRF_SAADC->RESOLUTION = SAADC_RESOLUTION_VAL_12bit;
+    NRF_SAADC->OVERSAMPLE = SAADC_OVERSAMPLE_OVERSAMPLE_Bypass;
+    NRF_SAADC->CH[0U].CONFIG = (SAADC_CH_CONFIG_GAIN_Gain1_6 << SAADC_CH_CONFIG_GAIN_Pos) |
+                               (SAADC_CH_CONFIG_REFSEL_Internal << SAADC_CH_CONFIG_REFSEL_Pos) |
+                               (SAADC_CH_CONFIG_TACQ_10us << SAADC_CH_CONFIG_TACQ_Pos) |
+                               (SAADC_CH_CONFIG_MODE_SE << SAADC_CH_CONFIG_MODE_Pos);
+    NRF_SAADC->CH[0U].PSELN = SAADC_CH_PSELN_PSELN_NC;
+    NRF_SAADC->CH[0U].PSELP = SAADC_CH_PSELP_PSELP_VDD;
+    NRF_SAADC->RESULT.PTR = (uint32_t)&sample;
+    NRF_SAADC->RESULT.MAXCNT = 1U;
+    NRF_SAADC->ENABLE = SAADC_ENABLE_ENABLE_Enabled;
+
+    NRF_SAADC->EVENTS_STARTED = 0U;
+    NRF_SAADC->TASKS_START = 1U;
+    while (0U == NRF_SAADC->EVENTS_STARTED)
+    {
+    }
+
+    NRF_SAADC->EVENTS_END = 0U;
+    NRF_SAADC->TASKS_SAMPLE = 1U;
+    while (0U == NRF_SAADC->EVENTS_END)
+    {
+    }
+
+    NRF_SAADC->EVENTS_STOPPED = 0U;
+    NRF_SAADC->TASKS_STOP = 1U;
+    while (0U == NRF_SAADC->EVENTS_STOPPED)
+    {
+    }
+
+    NRF_SAADC->CH[0U].PSELP = SAADC_CH_PSELP_PSELP_NC;
+    NRF_SAADC->ENABLE = SAADC_ENABLE_ENABLE_Disabled;
+
+    if (sample < 0)
+    {
+        return 0U;
+    }
+
+    return (uint16_t)(((uint32_t)sample * SUPPLY_SAADC_REFERENCE_MV * SUPPLY_SAADC_GAIN_RECIPROCAL) /
+                      SUPPLY_SAADC_RESOLUTION);
+}
\ No newline at end of file
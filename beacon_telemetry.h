@@ -0,0 +1,28 @@
+#ifndef BEACON_TELEMETRY_H__
+#define BEACON_TELEMETRY_H__
+
+#include <stdint.h>
+
+/*
+ * Telemetry format, advertised as manufacturer specific data in the scan response. Multi-byte
+ * fields are little endian.
+ *
+ * | Offset | Size | Content                                                    |
+ * |--------|------|------------------------------------------------------------|
+ * | 0      | 1    | Fix type, see LOCATION_FIX_NONE in location_data.h         |
+ * | 1      | 1    | Satellites used                                            |
+ * | 2      | 2    | Supply voltage in mV, uint16                               |
+ * | 4      | 4    | Uptime in s, uint32                                        |
+ * | 8      | 2    | Fixes received since reset, uint16, wraps around           |
+ *
+ * Fix type and satellites are BEACON_TELEMETRY_UNKNOWN if the receiver protocol does not
+ * report them.
+ */
+
+#define BEACON_TELEMETRY_LENGTH     10U
+#define BEACON_TELEMETRY_UNKNOWN    0xFFU
+
+void beacon_telemetry_init(void);
+uint8_t beacon_telemetry_encode(uint8_t *buffer, uint8_t capacity);
+
+#endif // BEACON_TELEMETRY_H__
\ No newline at end of file
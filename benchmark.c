@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <string.h>
+#include "nrf.h"
+#include "benchmark.h"
+#include "location_data.h"
+#include "location_parser.h"
+#include "gnss_handler.h"
+#include "beacon_payload.h"
+#include "benchmark_reference.h"
+
+#define BENCHMARK_ITERATIONS        1000U   /**< Calls per measurement, results are averaged. */
+#define BENCHMARK_REPORT_SIZE       UINT8_MAX
+
+static const LocationDataType sample_location[] =
+{
+    { .latitude =  53361337L, .longitude =   -6505620L },
+    { .latitude = -90000000L, .longitude = -180000000L },
+    { .latitude =    123456L, .longitude =  123456789L },
+    { .latitude =  -1000001L, .longitude =    9999999L }
+};
+
+static const char * const sample_line[] =
+{
+    "+53.361337,-6.505620",
+    "-90.000000,-180.000000",
+    ".123456,123.456789",
+    "-1.000001,+9.999999"
+};
+
+#define SAMPLE_COUNT    (sizeof(sample_location) / sizeof(sample_location[0U]))
+
+static uint8_t serialized[LATITUDE_MAX_DATA_SIZE + LONGITUDE_MAX_DATA_SIZE + 1U];
+static uint8_t encoded[BEACON_PAYLOAD_LENGTH];
+static char report[BENCHMARK_REPORT_SIZE];
+
+// Private method declarations
+static void cycle_counter_start(void);
+static uint32_t cycles_location_data_serialize(void);
+static uint32_t cycles_reference_serialize(void);
+static uint32_t cycles_location_parser_parse(void);
+static uint32_t cycles_reference_parse(void);
+static uint32_t cycles_beacon_payload_encode(void);
+
+/*
+ * Public methods
+ */
+
+/**@brief Measures the CPU cycles of the location data conversions and the payload encoding.
+ *
+ * @details Uses the DWT cycle counter and reports the average cycles per call over UART. Call
+ *          after the beacon manager has been initialized and before advertising is started, so
+ *          the SoftDevice is available for the ECB encryption of the secure payload format, but
+ *          measurements are not interrupted by radio activity.
+ */
+void benchmark_run(void)
+{
+    uint32_t serialize_cycles;
+    uint32_t reference_serialize_cycles;
+    uint32_t parse_cycles;
+    uint32_t reference_parse_cycles;
+    uint32_t encode_cycles;
+    int length;
+
+    cycle_counter_start();
+
+    serialize_cycles = cycles_location_data_serialize();
+    reference_serialize_cycles = cycles_reference_serialize();
+    parse_cycles = cycles_location_parser_parse();
+    reference_parse_cycles = cycles_reference_parse();
+    encode_cycles = cycles_beacon_payload_encode();
+
+    length = snprintf(report, sizeof(report),
+                      "Cycles: serialize %lu (reference %lu), parse %lu (%s, reference %lu), encode %lu (format %u)",
+                      (unsigned long)serialize_cycles, (unsigned long)reference_serialize_cycles, (unsigned long)parse_cycles,
+                      LOCATION_PARSER_SWAR ? "SWAR" : "bytewise", (unsigned long)reference_parse_cycles,
+                      (unsigned long)encode_cycles, (unsigned)BEACON_PAYLOAD_FORMAT);
+    if (length >= (int)sizeof(report))
+    {
+        // Truncated, send what fits
+        length = sizeof(report) - 1U;
+    }
+    if (length > 0)
+    {
+        gnss_handler_transmit((uint8_t *)report, (uint8_t)length);
+    }
+}
+
+/*
+ * Private methods
+ */
+
+static void cycle_counter_start(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0UL;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static uint32_t cycles_location_data_serialize(void)
+{
+    uint32_t start = DWT->CYCCNT;
+
+    for (uint32_t idx = 0U; idx < BENCHMARK_ITERATIONS; ++idx)
+    {
+        location_data_serialize(&sample_location[idx % SAMPLE_COUNT], serialized, sizeof(serialized));
+    }
+
+    return (DWT->CYCCNT - start) / BENCHMARK_ITERATIONS;
+}
+
+/**@brief Serializes the samples with the superseded % 10 / 10 serializer, see benchmark_reference.c. */
+static uint32_t cycles_reference_serialize(void)
+{
+    ReferenceLocationType location[SAMPLE_COUNT];
+    uint32_t start;
+
+    // The reference stores sign, degrees and decimal, converting is not part of its cost
+    for (uint32_t idx = 0U; idx < SAMPLE_COUNT; ++idx)
+    {
+        reference_location_from_data(&sample_location[idx], &location[idx]);
+    }
+
+    start = DWT->CYCCNT;
+
+    for (uint32_t idx = 0U; idx < BENCHMARK_ITERATIONS; ++idx)
+    {
+        reference_location_serialize(&location[idx % SAMPLE_COUNT], serialized, sizeof(serialized));
+    }
+
+    return (DWT->CYCCNT - start) / BENCHMARK_ITERATIONS;
+}
+
+static uint32_t cycles_location_parser_parse(void)
+{
+    LocationDataType location;
+    uint16_t length[SAMPLE_COUNT];
+    uint32_t start;
+
+    for (uint32_t idx = 0U; idx < SAMPLE_COUNT; ++idx)
+    {
+        length[idx] = strlen(sample_line[idx]);
+    }
+
+    start = DWT->CYCCNT;
+
+    for (uint32_t idx = 0U; idx < BENCHMARK_ITERATIONS; ++idx)
+    {
+        (void)location_parser_parse((const uint8_t *)sample_line[idx % SAMPLE_COUNT], length[idx % SAMPLE_COUNT],
+                                    &location, NULL);
+    }
+
+    return (DWT->CYCCNT - start) / BENCHMARK_ITERATIONS;
+}
+
+/**@brief Validates and sets the sample lines with the superseded code, see benchmark_reference.c. */
+static uint32_t cycles_reference_parse(void)
+{
+    ReferenceLocationType location;
+    uint8_t length[SAMPLE_COUNT];
+    uint32_t start;
+
+    for (uint32_t idx = 0U; idx < SAMPLE_COUNT; ++idx)
+    {
+        length[idx] = strlen(sample_line[idx]);
+    }
+
+    start = DWT->CYCCNT;
+
+    for (uint32_t idx = 0U; idx < BENCHMARK_ITERATIONS; ++idx)
+    {
+        const uint8_t *line = (const uint8_t *)sample_line[idx % SAMPLE_COUNT];
+
+        if (reference_validate_location_data(line, length[idx % SAMPLE_COUNT], &location))
+        {
+            reference_set_location_data(line, length[idx % SAMPLE_COUNT], &location);
+        }
+    }
+
+    return (DWT->CYCCNT - start) / BENCHMARK_ITERATIONS;
+}
+
+/**@brief Encodes the newest fix, for the secure format this includes three ECB blocks per call. */
+static uint32_t cycles_beacon_payload_encode(void)
+{
+    BeaconTrackType track;
+    uint32_t start;
+
+    beacon_track_init(&track);
+    for (uint32_t idx = 0U; idx < SAMPLE_COUNT; ++idx)
+    {
+        beacon_track_add(&track, &sample_location[idx], idx * 1000UL);
+    }
+
+    start = DWT->CYCCNT;
+
+    for (uint32_t idx = 0U; idx < BENCHMARK_ITERATIONS; ++idx)
+    {
+        (void)beacon_payload_encode(&track, (uint8_t)idx, encoded, sizeof(encoded));
+    }
+
+    return (DWT->CYCCNT - start) / BENCHMARK_ITERATIONS;
+}
\ No newline at end of file
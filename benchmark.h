@@ -0,0 +1,8 @@
+#ifndef BENCHMARK_H__
+#define BENCHMARK_H__
+
+#include <stdint.h>
+
+void benchmark_run(void);
+
+#endif // BENCHMARK_H__
\ No newline at end of file
@@ -0,0 +1,277 @@
+#include <stddef.h>
+#include <ctype.h>
+#include "benchmark_reference.h"
+
+/*
+ * Superseded implementations, kept unchanged as the baseline of the benchmarks. Not used by the
+ * application.
+ */
+
+#define DECIMAL_PRECISION           6U  /**< Decimal precision of location data. */
+#define MAX_ABS_LATITUDE           90U  /**< Maximum absolute latitude */
+#define MAX_ABS_LONGITUDE         180U  /**< Maximum absolute longitude */
+
+// Private method declarations
+static int8_t search_char(const uint8_t *buffer, uint8_t buffer_size, char c);
+static bool validate_coordinate(const uint8_t *buffer, uint8_t buffer_size, uint8_t decimal_pos, uint8_t max_degrees);
+static void set_coordinate(const uint8_t *buffer, uint8_t buffer_size, CoordinateType *coordinate);
+
+/*
+ * Public methods
+ */
+
+/**@brief Validates location data.
+ *
+ * @details Line validation of the location service before the table-driven location parser.
+ *          Searches the comma and the decimal points first and checks the digits of each
+ *          coordinate in a second pass.
+ */
+bool reference_validate_location_data(const uint8_t * buffer, uint8_t received_bytes, ReferenceLocationType * location)
+{
+    bool is_valid_latitude = true;
+    bool is_valid_longitude = true;
+    int8_t comma_pos = 0U;
+    int8_t decimal_pos = 0U;
+
+    // Check input params
+    if ((NULL == buffer ) || (NULL == location) || (0U == received_bytes))
+    {
+        return false;
+    }
+
+    // Search comma
+    comma_pos = search_char(buffer, received_bytes, ',');
+
+    if ((comma_pos > 0) && (comma_pos < received_bytes))
+    {
+        decimal_pos = search_char(buffer, comma_pos, '.');
+        if ((decimal_pos >= 0) && (decimal_pos < 4) &&
+            ((comma_pos - decimal_pos - 1) == DECIMAL_PRECISION))
+        {
+            is_valid_latitude = validate_coordinate(buffer, comma_pos, decimal_pos, MAX_ABS_LATITUDE);
+        }
+        else
+        {
+            is_valid_latitude = false;
+        }
+
+        if (is_valid_latitude)
+        {
+            uint8_t longitude_received_bytes = received_bytes - comma_pos - 1;
+            const uint8_t *longitude_buffer = &buffer[comma_pos + 1U];
+
+            decimal_pos = search_char(longitude_buffer, longitude_received_bytes, '.');
+            if ((decimal_pos >= 0) && (decimal_pos < 5) &&
+                ((longitude_received_bytes - decimal_pos - 1) == DECIMAL_PRECISION))
+            {
+                is_valid_longitude = validate_coordinate(longitude_buffer, longitude_received_bytes, decimal_pos, MAX_ABS_LONGITUDE);
+            }
+            else
+            {
+                is_valid_longitude = false;
+            }
+        }
+    }
+    else
+    {
+        is_valid_latitude = false;
+        is_valid_longitude = false;
+    }
+    
+    return (is_valid_latitude && is_valid_longitude);
+}
+
+/**@brief Sets location data.
+ * 
+ * @attention   This function does not validate data in input buffer!
+*/
+void reference_set_location_data(const uint8_t *buffer, uint8_t received_bytes, ReferenceLocationType *location)
+{
+    uint8_t comma_pos = 0U;
+
+    if ((NULL != buffer) && (NULL != location) && (received_bytes > 0U))
+    {
+        comma_pos   = search_char(buffer, received_bytes, ',');
+
+        set_coordinate(buffer, comma_pos, &location->latitude);
+
+        const uint8_t *longitude_buffer = &buffer[comma_pos + 1U];
+        uint8_t longitude_received_bytes = received_bytes - comma_pos - 1U;
+        set_coordinate(longitude_buffer, longitude_received_bytes, &location->longitude);
+    }
+}
+
+/**@brief Converts location data to string
+ *
+ * @details Serializer of the location data before the digit pair table, writes each digit with
+ *          a % 10 and / 10 step.
+ */
+void reference_location_serialize(const ReferenceLocationType *location_data, uint8_t *buffer, uint8_t buffer_size)
+{
+    if (buffer_size >= (LATITUDE_MAX_DATA_SIZE + LONGITUDE_MAX_DATA_SIZE + 1U))
+    {
+        buffer[LATITUDE_MAX_DATA_SIZE] = ',';
+
+        buffer[0U] = (location_data->latitude.sign > 0) ? '+' : '-';
+        buffer[3U] = '.';
+        uint8_t idx = 2U;
+        uint32_t tmp = location_data->latitude.degrees;
+        while (idx > 0U)
+        {
+            buffer[idx] = '0'+ (tmp % 10U);
+            tmp /= 10U;
+            --idx;
+        }
+        idx = DECIMAL_PRECISION;
+        tmp = location_data->latitude.decimal;
+        while (idx > 0U)
+        {
+            buffer[3U + idx] = '0' + (tmp % 10U);
+            tmp /= 10U;
+            --idx;
+        }
+
+        buffer[LATITUDE_MAX_DATA_SIZE + 1U] = (location_data->longitude.sign > 0) ? '+' : '-';
+        buffer[LATITUDE_MAX_DATA_SIZE + 5U] = '.';
+        idx = 3U;
+        tmp = location_data->longitude.degrees;
+        while (idx > 0U)
+        {
+            buffer[LATITUDE_MAX_DATA_SIZE + 1U + idx] = '0' + (tmp % 10U);
+            tmp /= 10U;
+            --idx;
+        }
+        idx = DECIMAL_PRECISION;
+        tmp = location_data->longitude.decimal;
+        while (idx > 0U)
+        {
+            buffer[LATITUDE_MAX_DATA_SIZE + 5U + idx] = '0' + (tmp % 10U);
+            tmp /= 10U;
+            --idx;
+        }
+    }
+}
+
+/**@brief Converts a location of the reference code to micro-degrees, for comparing results. */
+void reference_location_to_data(const ReferenceLocationType *reference, LocationDataType *location)
+{
+    location->latitude = coordinate_to_micro_degrees(&reference->latitude);
+    location->longitude = coordinate_to_micro_degrees(&reference->longitude);
+}
+
+/**@brief Converts a location in micro-degrees to the representation of the reference code. */
+void reference_location_from_data(const LocationDataType *location, ReferenceLocationType *reference)
+{
+    coordinate_from_micro_degrees(&reference->latitude, location->latitude);
+    coordinate_from_micro_degrees(&reference->longitude, location->longitude);
+}
+
+/*
+ * Private methods
+ */
+
+static void set_coordinate(const uint8_t *buffer, uint8_t buffer_size, CoordinateType *coordinate)
+{
+    uint8_t idx = 0U;
+    uint8_t decimal_pos = search_char(buffer, buffer_size, '.');
+
+    if ('+' == buffer[idx])
+    {
+        coordinate->sign = 1;
+        ++idx;
+    }
+    else if ('-' == buffer[idx])
+    {
+        coordinate->sign = -1;
+        ++idx;
+    }
+    else
+    {
+        coordinate->sign = 1;
+    }
+
+    coordinate->degrees = 0U;
+    for (; idx < decimal_pos; ++idx)
+    {
+        coordinate->degrees *= 10U;
+        coordinate->degrees += (buffer[idx] - '0');
+    }
+
+    coordinate->decimal = 0UL;
+    for (idx = decimal_pos + 1U; idx < buffer_size; ++idx)
+    {
+        coordinate->decimal *= 10U;
+        coordinate->decimal += (buffer[idx] - '0');
+    }
+}
+
+static int8_t search_char(const uint8_t * buffer, uint8_t buffer_size, char c)
+{
+    int8_t pos = -1;
+
+    for (uint8_t idx = 0U; idx < buffer_size; ++idx)
+    {
+        if (c == buffer[idx])
+        {
+            pos = idx;
+            break;
+        }
+    }
+
+    return pos;
+}
+
+static bool validate_coordinate(const uint8_t *buffer, uint8_t buffer_size, uint8_t decimal_pos, uint8_t max_degrees)
+{
+    bool is_valid = true;
+    uint8_t idx = 0U;
+    uint8_t degrees = 0U;
+
+    // Check leading sign
+    if (('+' == buffer[idx]) || ('-' == buffer[idx]))
+    {
+        ++idx;
+    }
+
+    // Check degrees
+    for (; idx < decimal_pos; ++idx)
+    {
+        char c = buffer[idx];
+        if (isdigit(c) == 0)
+        {
+            is_valid = false;
+            break;
+        }
+        else
+        {
+            degrees *= 10;
+            degrees += (c - '0');
+        }
+    }
+
+    // Check decimal degrees
+    if (is_valid)
+    {
+        for (idx = decimal_pos + 1U; idx < buffer_size; ++idx)
+        {
+            if (degrees < max_degrees)
+            {
+                if (isdigit(buffer[idx]) == 0)
+                {
+                    is_valid = false;
+                    break;
+                }
+            }
+            else
+            {
+                if ('0' != buffer[idx])
+                {
+                    is_valid = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    return is_valid;
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#ifndef BENCHMARK_REFERENCE_H__
+#define BENCHMARK_REFERENCE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "location_data.h"
+
+/**@brief Location as stored by the reference code, coordinates split as in location lines. */
+typedef struct ReferenceLocation
+{
+    CoordinateType latitude;
+    CoordinateType longitude;
+} ReferenceLocationType;
+
+bool reference_validate_location_data(const uint8_t *buffer, uint8_t received_bytes, ReferenceLocationType *location);
+void reference_set_location_data(const uint8_t *buffer, uint8_t received_bytes, ReferenceLocationType *location);
+void reference_location_serialize(const ReferenceLocationType *location_data, uint8_t *buffer, uint8_t buffer_size);
+void reference_location_to_data(const ReferenceLocationType *reference, LocationDataType *location);
+void reference_location_from_data(const LocationDataType *location, ReferenceLocationType *reference);
+
+#endif // BENCHMARK_REFERENCE_H__
\ No newline at end of file
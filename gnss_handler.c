@@ -2,103 +2,277 @@
 #include <string.h>
 #include <stdlib.h>
 #include "gnss_handler.h"
+#include "gnss_protocol.h"
 #include "bsp.h"
 #include "nrf_uarte.h"
-#include "app_uart.h"
+#include "nrfx_uarte.h"
+#include "nrfx_timer.h"
+#include "nrfx_ppi.h"
+#include "app_util_platform.h"
+#include "app_timer.h"
 #include "app_error.h"
+#if (GNSS_PROTOCOL == GNSS_PROTOCOL_NMEA)
+#include "nmea_parser.h"
+#elif (GNSS_PROTOCOL == GNSS_PROTOCOL_UBX)
+#include "ubx_parser.h"
+#elif (GNSS_PROTOCOL == GNSS_PROTOCOL_ASCII)
+#include "location_parser.h"
+#endif
 
-#define UART_RX_BUF_SIZE 256U
-#define UART_TX_BUF_SIZE 256U
-#define UART_NO_PARITY false
+#ifndef UART_BAUDRATE
+#define UART_BAUDRATE               NRF_UARTE_BAUDRATE_460800   /**< Baudrate of the GNSS receiver interface. */
+#endif
+#define UART_RX_DMA_BUF_SIZE        128U                        /**< Size of each of the two EasyDMA receive buffers. */
+#define UART_RX_IDLE_TIMEOUT_US     500U                        /**< Line idle time after which received bytes are handed over. */
+#define UART_RX_DRAIN_BYTES         16U                         /**< Received bytes after which they are handed over while the line is busy. */
+#define UART_TX_BUF_SIZE            (UINT8_MAX + 2U)            /**< Maximum transmit size including CR LF. */
+
+#define LINE_SLOT_COUNT             8U                          /**< Number of line slots, must be a power of two. */
+#define LINE_SLOT_SIZE              96U                         /**< Maximum line length, fits an NMEA sentence. */
 
-#define DATA_BUFFER_SIZE 32U
 #define CR  '\r'
 #define LF  '\n'
 #define EOL '\0'
 
-static bool received_new_line;
-static uint8_t data_buffer[DATA_BUFFER_SIZE];
+static const nrfx_uarte_t uarte = NRFX_UARTE_INSTANCE(0);               /**< UARTE instance connected to the GNSS receiver. */
+static const nrfx_timer_t rx_byte_counter = NRFX_TIMER_INSTANCE(1);     /**< Counts received bytes via PPI, fires every UART_RX_DRAIN_BYTES. */
+static const nrfx_timer_t rx_idle_timer = NRFX_TIMER_INSTANCE(2);       /**< Restarted by every received byte, expires on idle line. */
+
+static uint8_t rx_dma_buffer[2U][UART_RX_DMA_BUF_SIZE];
+static uint8_t rx_dma_idx;          /**< Index of the DMA buffer currently written by the UARTE. */
+static uint32_t rx_buffer_start;    /**< Byte count at the start of the current DMA buffer. */
+static uint32_t rx_handed_over;     /**< Byte count already handed over to the line assembly. */
+static uint8_t tx_buffer[UART_TX_BUF_SIZE];
+
+/**@brief Descriptor of a completed line within the line storage. */
+typedef struct LineDescriptor
+{
+    uint16_t offset;
+    uint16_t length;
+    uint32_t timestamp;
+} LineDescriptorType;
+
+static uint8_t line_storage[LINE_SLOT_COUNT * LINE_SLOT_SIZE];
+static LineDescriptorType line_descriptor[LINE_SLOT_COUNT];
+static volatile uint8_t line_head;      /**< Slot currently assembled from received bytes. */
+static volatile uint8_t line_tail;      /**< Oldest completed line not yet released. */
+static volatile bool line_acquired;     /**< Line at line_tail is in use by the consumer. */
+static uint16_t line_fill;              /**< Number of bytes in the slot at line_head. */
+static bool line_overflow;              /**< Line at line_head exceeded LINE_SLOT_SIZE. */
+static volatile uint32_t lines_dropped;
 
-static void uart_error_handle(app_uart_evt_t * p_event);
+#if (GNSS_PROTOCOL == GNSS_PROTOCOL_NMEA)
+static const GnssProtocolType * const protocol = &nmea_protocol;
+#elif (GNSS_PROTOCOL == GNSS_PROTOCOL_UBX)
+static const GnssProtocolType * const protocol = &ubx_protocol;
+#elif (GNSS_PROTOCOL == GNSS_PROTOCOL_ASCII)
+static const GnssProtocolType * const protocol = &location_protocol;
+#else
+static const GnssProtocolType * const protocol = NULL;
+#endif
+static LocationRecordType protocol_location;        /**< Location record assembled by the protocol backend. */
+static LocationRecordType received_location;        /**< Latest complete location record. */
+static uint32_t received_timestamp;                 /**< app_timer counter value when the latest record was completed. */
+static volatile bool received_new_location;
+static volatile uint32_t parse_errors;
+
+static void uarte_event_handle(nrfx_uarte_event_t const * p_event, void * p_context);
+static void rx_idle_timer_event_handle(nrf_timer_event_t event_type, void * p_context);
+static void rx_byte_counter_event_handle(nrf_timer_event_t event_type, void * p_context);
+static void rx_idle_detection_init(void);
+static void rx_flush(uint32_t byte_count);
+static void rx_data_process(const uint8_t * data, uint32_t length);
+static void rx_line_assemble(const uint8_t * data, uint32_t length);
+static void rx_protocol_parse(const uint8_t * data, uint32_t length);
+static void line_commit(void);
 
 uint32_t gnss_handler_init(void)
 {
     uint32_t err_code = NRF_SUCCESS;
 
-    const app_uart_comm_params_t comm_params =
+    const nrfx_uarte_config_t uarte_config =
     {
-        RX_PIN_NUMBER,
-        TX_PIN_NUMBER,
-        RTS_PIN_NUMBER,
-        CTS_PIN_NUMBER,
-        APP_UART_FLOW_CONTROL_DISABLED,
-        UART_NO_PARITY,
-        NRF_UARTE_BAUDRATE_115200
+        .pseltxd            = TX_PIN_NUMBER,
+        .pselrxd            = RX_PIN_NUMBER,
+        .pselcts            = NRF_UARTE_PSEL_DISCONNECTED,
+        .pselrts            = NRF_UARTE_PSEL_DISCONNECTED,
+        .p_context          = NULL,
+        .hwfc               = NRF_UARTE_HWFC_DISABLED,
+        .parity             = NRF_UARTE_PARITY_EXCLUDED,
+        .baudrate           = UART_BAUDRATE,
+        .interrupt_priority = APP_IRQ_PRIORITY_LOWEST
     };
 
-    received_new_line = false;
-    memset(data_buffer, 0U, DATA_BUFFER_SIZE);
+    for (uint8_t idx = 0U; idx < LINE_SLOT_COUNT; ++idx)
+    {
+        line_descriptor[idx].offset = idx * LINE_SLOT_SIZE;
+        line_descriptor[idx].length = 0U;
+        line_descriptor[idx].timestamp = 0UL;
+    }
+    line_head = 0U;
+    line_tail = 0U;
+    line_acquired = false;
+    line_fill = 0U;
+    line_overflow = false;
+    lines_dropped = 0UL;
+
+    location_record_init(&protocol_location);
+    location_record_init(&received_location);
+    received_timestamp = 0UL;
+    received_new_location = false;
+    parse_errors = 0UL;
+    if (NULL != protocol)
+    {
+        protocol->reset();
+    }
+
+    rx_dma_idx = 0U;
+    rx_buffer_start = 0UL;
+    rx_handed_over = 0UL;
+
+    err_code = nrfx_uarte_init(&uarte, &uarte_config, uarte_event_handle);
+    APP_ERROR_CHECK(err_code);
+
+    rx_idle_detection_init();
 
-    APP_UART_FIFO_INIT(&comm_params,
-                       UART_RX_BUF_SIZE,
-                       UART_TX_BUF_SIZE,
-                       uart_error_handle,
-                       APP_IRQ_PRIORITY_LOWEST,
-                       err_code);
+    // Provide both buffers, the UARTE switches to the second one without CPU intervention.
+    err_code = nrfx_uarte_rx(&uarte, rx_dma_buffer[0U], UART_RX_DMA_BUF_SIZE);
+    APP_ERROR_CHECK(err_code);
 
+    err_code = nrfx_uarte_rx(&uarte, rx_dma_buffer[1U], UART_RX_DMA_BUF_SIZE);
     APP_ERROR_CHECK(err_code);
 
     return err_code;
 }
 
-bool gnss_handler_receive(uint8_t * idx, uint8_t * buffer, uint8_t buffer_size)
+/**@brief Acquires the newest received line.
+ *
+ * @details Latest wins: if the consumer fell behind, older completed lines are skipped and
+ *          counted as dropped, so outdated lines are neither parsed nor dispatched. The returned
+ *          span points into the receive storage and stays valid until gnss_handler_line_release()
+ *          is called. Acquiring again before releasing returns the same line.
+ *
+ * @param[out]  line    Span of the received line without CR/LF.
+ *
+ * @returns true if a line is available, false otherwise.
+ */
+bool gnss_handler_line_acquire(GnssLineType * line)
 {
-    bool new_location_received = false;
-    uint8_t c;
+    bool line_available = false;
 
-    // Check input params
-    if ((NULL != idx) && (NULL != buffer) && (0U < buffer_size))
+    if (NULL != line)
     {
-        while(NRF_SUCCESS == app_uart_get(&c))
+        CRITICAL_REGION_ENTER();
+        if (line_tail != line_head)
         {
-            if ((CR == c) || (LF == c))
-            {
-                new_location_received = true;
-            }
-            else if (*idx < buffer_size)
+            if (!line_acquired)
             {
-                buffer[*idx] = c;
-                ++(*idx);
+                uint8_t newest = (line_head - 1U) & (LINE_SLOT_COUNT - 1U);
+
+                lines_dropped += (newest - line_tail) & (LINE_SLOT_COUNT - 1U);
+                line_tail = newest;
             }
+
+            const LineDescriptorType * descriptor = &line_descriptor[line_tail];
+
+            line->p_data    = &line_storage[descriptor->offset];
+            line->length    = descriptor->length;
+            line->timestamp = descriptor->timestamp;
+            line_acquired   = true;
+            line_available  = true;
         }
+        CRITICAL_REGION_EXIT();
+    }
+
+    return line_available;
+}
 
-        // remove any trailing CR or LF
-        if (*idx >= 2U)
+/**@brief Releases the line returned by gnss_handler_line_acquire(). */
+void gnss_handler_line_release(void)
+{
+    CRITICAL_REGION_ENTER();
+    if (line_acquired)
+    {
+        line_tail = (line_tail + 1U) & (LINE_SLOT_COUNT - 1U);
+        line_acquired = false;
+    }
+    CRITICAL_REGION_EXIT();
+}
+
+/**@brief Returns the number of lines dropped because they were too long or the consumer fell behind. */
+uint32_t gnss_handler_lines_dropped(void)
+{
+    return lines_dropped;
+}
+
+/**@brief Gets the latest location decoded by the protocol backend.
+ *
+ * @details Only used if a receiver protocol backend is selected by GNSS_PROTOCOL. If several
+ *          locations have been decoded since the last call, only the latest one is returned.
+ *          Fields the receiver protocol does not provide are flagged invalid in the record.
+ *
+ * @param[out]  location    Latest location record.
+ * @param[out]  timestamp   app_timer counter value when the record was completed.
+ *
+ * @returns true if a new location record is available, false otherwise.
+ */
+bool gnss_handler_location_get(LocationRecordType * location, uint32_t * timestamp)
+{
+    bool new_location_received = false;
+
+    if ((NULL != location) && (NULL != timestamp))
+    {
+        CRITICAL_REGION_ENTER();
+        if (received_new_location)
         {
-            if ((CR == buffer[*idx - 2U]) || (LF == buffer[*idx - 2U]))
-            {
-                *idx -= 2U;
-            }
-            else if ((CR == buffer[*idx - 1U]) || (LF == buffer[*idx - 1U]))
-            {
-                --(*idx);
-            }
+            *location = received_location;
+            *timestamp = received_timestamp;
+            received_new_location = false;
+            new_location_received = true;
         }
+        CRITICAL_REGION_EXIT();
     }
 
     return new_location_received;
 }
 
+/**@brief Returns the number of messages rejected by the protocol backend. */
+uint32_t gnss_handler_parse_errors(void)
+{
+    return parse_errors;
+}
+
+/**@brief Gets the receiver status reported by the protocol backend.
+ *
+ * @param[out]  status      Receiver status, see @ref GnssStatusType.
+ *
+ * @returns true if the protocol backend reports the receiver status, false otherwise.
+ */
+bool gnss_handler_status_get(GnssStatusType * status)
+{
+    if ((NULL == status) || (NULL == protocol) || (NULL == protocol->status))
+    {
+        return false;
+    }
+
+    // Updated by the backend from the UARTE interrupt.
+    CRITICAL_REGION_ENTER();
+    protocol->status(status);
+    CRITICAL_REGION_EXIT();
+
+    return true;
+}
+
 void gnss_handler_transmit(const uint8_t * buffer, uint8_t buffer_size)
 {
-    if ((NULL != buffer) && (buffer_size > 0U))
+    if ((NULL != buffer) && (buffer_size > 0U) && !nrfx_uarte_tx_in_progress(&uarte))
     {
-        for (uint8_t idx = 0U; idx < buffer_size; ++idx)
-        {
-            app_uart_put(buffer[idx]);
-        }
-        app_uart_put(CR);
-        app_uart_put(LF);
+        memcpy(tx_buffer, buffer, buffer_size);
+        tx_buffer[buffer_size] = CR;
+        tx_buffer[buffer_size + 1U] = LF;
+
+        // Dropped if the UARTE is busy, transmission is best effort only.
+        (void)nrfx_uarte_tx(&uarte, tx_buffer, buffer_size + 2U);
     }
 }
 
@@ -106,19 +280,245 @@ void gnss_handler_transmit(const uint8_t * buffer, uint8_t buffer_size)
  * Private methods
  */
 
-static void uart_error_handle(app_uart_evt_t * p_event)
+/**@brief Sets up idle line detection.
+ *
+ * @details Every RXDRDY event increments a byte counter and restarts the idle timer via PPI, so the
+ *          CPU is not involved for single bytes. The byte counter interrupts every
+ *          UART_RX_DRAIN_BYTES, so bytes are consumed in small chunks while they arrive and the
+ *          end of a line only costs the few bytes since the last chunk. The bytes of a burst that
+ *          did not fill a chunk are processed once the line has been idle for
+ *          UART_RX_IDLE_TIMEOUT_US.
+ */
+static void rx_idle_detection_init(void)
+{
+    uint32_t err_code;
+    nrf_ppi_channel_t count_channel;
+    nrf_ppi_channel_t restart_channel;
+
+    nrfx_timer_config_t timer_config =
+    {
+        .frequency          = NRF_TIMER_FREQ_1MHz,
+        .mode               = NRF_TIMER_MODE_COUNTER,
+        .bit_width          = NRF_TIMER_BIT_WIDTH_32,
+        .interrupt_priority = APP_IRQ_PRIORITY_LOWEST,
+        .p_context          = NULL
+    };
+
+    err_code = nrfx_timer_init(&rx_byte_counter, &timer_config, rx_byte_counter_event_handle);
+    APP_ERROR_CHECK(err_code);
+
+    timer_config.mode = NRF_TIMER_MODE_TIMER;
+    err_code = nrfx_timer_init(&rx_idle_timer, &timer_config, rx_idle_timer_event_handle);
+    APP_ERROR_CHECK(err_code);
+
+    nrfx_timer_extended_compare(&rx_idle_timer,
+                                NRF_TIMER_CC_CHANNEL0,
+                                nrfx_timer_us_to_ticks(&rx_idle_timer, UART_RX_IDLE_TIMEOUT_US),
+                                NRF_TIMER_SHORT_COMPARE0_STOP_MASK | NRF_TIMER_SHORT_COMPARE0_CLEAR_MASK,
+                                true);
+
+    err_code = nrfx_ppi_channel_alloc(&count_channel);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = nrfx_ppi_channel_alloc(&restart_channel);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = nrfx_ppi_channel_assign(count_channel,
+                                       nrfx_uarte_event_address_get(&uarte, NRF_UARTE_EVENT_RXDRDY),
+                                       nrfx_timer_task_address_get(&rx_byte_counter, NRF_TIMER_TASK_COUNT));
+    APP_ERROR_CHECK(err_code);
+
+    err_code = nrfx_ppi_channel_fork_assign(count_channel,
+                                            nrfx_timer_task_address_get(&rx_idle_timer, NRF_TIMER_TASK_CLEAR));
+    APP_ERROR_CHECK(err_code);
+
+    err_code = nrfx_ppi_channel_assign(restart_channel,
+                                       nrfx_uarte_event_address_get(&uarte, NRF_UARTE_EVENT_RXDRDY),
+                                       nrfx_timer_task_address_get(&rx_idle_timer, NRF_TIMER_TASK_START));
+    APP_ERROR_CHECK(err_code);
+
+    nrfx_timer_compare(&rx_byte_counter, NRF_TIMER_CC_CHANNEL1, UART_RX_DRAIN_BYTES, true);
+    nrfx_timer_enable(&rx_byte_counter);
+
+    err_code = nrfx_ppi_channel_enable(count_channel);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = nrfx_ppi_channel_enable(restart_channel);
+    APP_ERROR_CHECK(err_code);
+}
+
+static void uarte_event_handle(nrfx_uarte_event_t const * p_event, void * p_context)
 {
-    switch(p_event->evt_type)
+    uint32_t err_code;
+
+    switch(p_event->type)
     {
-    case APP_UART_COMMUNICATION_ERROR:
-        APP_ERROR_HANDLER(p_event->data.error_communication);
+    case NRFX_UARTE_EVT_RX_DONE:
+        // DMA buffer is full, the UARTE already continues in the other buffer.
+        rx_flush(rx_buffer_start + p_event->data.rxtx.bytes);
+        rx_buffer_start += p_event->data.rxtx.bytes;
+        rx_dma_idx ^= 1U;
+
+        err_code = nrfx_uarte_rx(&uarte, p_event->data.rxtx.p_data, UART_RX_DMA_BUF_SIZE);
+        APP_ERROR_CHECK(err_code);
         break;
 
-    case APP_UART_FIFO_ERROR:
-        APP_ERROR_HANDLER(p_event->data.error_code);
+    case NRFX_UARTE_EVT_ERROR:
+        APP_ERROR_HANDLER(p_event->data.error.error_mask);
         break;
-    
+
     default:
         break;
     }
+}
+
+static void rx_idle_timer_event_handle(nrf_timer_event_t event_type, void * p_context)
+{
+    if (NRF_TIMER_EVENT_COMPARE0 == event_type)
+    {
+        rx_flush(nrfx_timer_capture(&rx_byte_counter, NRF_TIMER_CC_CHANNEL0));
+    }
+}
+
+static void rx_byte_counter_event_handle(nrf_timer_event_t event_type, void * p_context)
+{
+    if (NRF_TIMER_EVENT_COMPARE1 == event_type)
+    {
+        // The newest byte may not be in RAM yet, it is handed over with the next chunk.
+        rx_flush(nrfx_timer_capture(&rx_byte_counter, NRF_TIMER_CC_CHANNEL0) - 1UL);
+    }
+}
+
+/**@brief Hands over all bytes of the current DMA buffer up to the given byte count.
+ *
+ * @details Called from the UARTE, idle timer and byte counter interrupts which run at the same
+ *          priority. Bytes which are counted but belong to the next DMA buffer are left for the
+ *          subsequent RX_DONE event. The byte counter is rearmed to fire UART_RX_DRAIN_BYTES
+ *          after the bytes received so far.
+ */
+static void rx_flush(uint32_t byte_count)
+{
+    uint32_t available;
+    uint32_t processed = rx_handed_over - rx_buffer_start;
+
+    nrfx_timer_compare(&rx_byte_counter, NRF_TIMER_CC_CHANNEL1,
+                       nrfx_timer_capture(&rx_byte_counter, NRF_TIMER_CC_CHANNEL0) + UART_RX_DRAIN_BYTES, true);
+
+    // A chunk may end right at the start of the DMA buffer
+    if (byte_count <= rx_handed_over)
+    {
+        return;
+    }
+
+    available = byte_count - rx_buffer_start;
+    if (available > UART_RX_DMA_BUF_SIZE)
+    {
+        available = UART_RX_DMA_BUF_SIZE;
+    }
+
+    if (available > processed)
+    {
+        rx_data_process(&rx_dma_buffer[rx_dma_idx][processed], available - processed);
+        rx_handed_over += (available - processed);
+    }
+}
+
+/**@brief Passes received bytes to the selected protocol backend or assembles them to lines. */
+static void rx_data_process(const uint8_t * data, uint32_t length)
+{
+    if (NULL != protocol)
+    {
+        rx_protocol_parse(data, length);
+    }
+    else
+    {
+        rx_line_assemble(data, length);
+    }
+}
+
+/**@brief Feeds received bytes to the protocol backend and publishes completed locations. */
+static void rx_protocol_parse(const uint8_t * data, uint32_t length)
+{
+    for (uint32_t idx = 0U; idx < length; ++idx)
+    {
+        switch (protocol->parse(data[idx], &protocol_location))
+        {
+        case GNSS_PARSE_LOCATION:
+            received_location = protocol_location;
+            received_timestamp = app_timer_cnt_get();
+            received_new_location = true;
+            break;
+
+        case GNSS_PARSE_ERROR:
+            ++parse_errors;
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+/**@brief Assembles received bytes to lines.
+ *
+ * @details Bytes are written directly into the line slot at line_head. Any CR or LF terminates a
+ *          line, empty lines are ignored and lines exceeding LINE_SLOT_SIZE are dropped.
+ */
+static void rx_line_assemble(const uint8_t * data, uint32_t length)
+{
+    uint8_t * slot = &line_storage[line_descriptor[line_head].offset];
+
+    for (uint32_t idx = 0U; idx < length; ++idx)
+    {
+        uint8_t c = data[idx];
+
+        if ((CR == c) || (LF == c))
+        {
+            if (line_overflow)
+            {
+                ++lines_dropped;
+            }
+            else if (line_fill > 0U)
+            {
+                line_commit();
+                slot = &line_storage[line_descriptor[line_head].offset];
+            }
+            line_fill = 0U;
+            line_overflow = false;
+        }
+        else if (line_fill < LINE_SLOT_SIZE)
+        {
+            slot[line_fill] = c;
+            ++line_fill;
+        }
+        else
+        {
+            line_overflow = true;
+        }
+    }
+}
+
+/**@brief Completes the line at line_head and advances to the next slot.
+ *
+ * @details Latest wins: if the consumer fell behind and all slots are in use, the oldest line is
+ *          dropped. If the oldest line is currently acquired, the new line is dropped instead.
+ */
+static void line_commit(void)
+{
+    uint8_t next = (line_head + 1U) & (LINE_SLOT_COUNT - 1U);
+
+    line_descriptor[line_head].length = line_fill;
+    line_descriptor[line_head].timestamp = app_timer_cnt_get();
+
+    if (next == line_tail)
+    {
+        ++lines_dropped;
+        if (line_acquired)
+        {
+            return;
+        }
+        line_tail = (line_tail + 1U) & (LINE_SLOT_COUNT - 1U);
+    }
+
+    line_head = next;
 }
\ No newline at end of file
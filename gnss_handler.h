@@ -2,9 +2,34 @@
 #define GNSS_HANDLER_H__
 
 #include <stdint.h>
+#include <stdbool.h>
+#include "location_data.h"
+#include "gnss_protocol.h"
+
+#define GNSS_PROTOCOL_LINE      0   /**< ASCII location lines, parsed by the location service. */
+#define GNSS_PROTOCOL_ASCII     3   /**< ASCII location lines, parsed while receiving. */
+#define GNSS_PROTOCOL_NMEA      1   /**< NMEA 0183 receiver, parsed while receiving. */
+#define GNSS_PROTOCOL_UBX       2   /**< u-blox receiver sending UBX-NAV-PVT, parsed while receiving. */
+
+#ifndef GNSS_PROTOCOL
+#define GNSS_PROTOCOL           GNSS_PROTOCOL_ASCII  /**< Protocol of the connected GNSS receiver. */
+#endif
+
+/**@brief Read-only span of a received line within the receive storage. */
+typedef struct GnssLine
+{
+    const uint8_t * p_data;     /**< First byte of the line, not zero terminated. */
+    uint16_t length;            /**< Length of the line without CR/LF. */
+    uint32_t timestamp;         /**< app_timer counter value when the line was completed. */
+} GnssLineType;
 
 uint32_t gnss_handler_init(void);
-bool gnss_handler_receive(uint8_t *received_bytes, uint8_t *buffer, uint8_t buffer_size);
+bool gnss_handler_line_acquire(GnssLineType *line);
+void gnss_handler_line_release(void);
+uint32_t gnss_handler_lines_dropped(void);
+bool gnss_handler_location_get(LocationRecordType *location, uint32_t *timestamp);
+uint32_t gnss_handler_parse_errors(void);
+bool gnss_handler_status_get(GnssStatusType *status);
 void gnss_handler_transmit(const uint8_t *buffer, uint8_t buffer_size);
 
 #endif // GNSS_HANDLER_H__
\ No newline at end of file
@@ -0,0 +1,37 @@
+#ifndef GNSS_PROTOCOL_H__
+#define GNSS_PROTOCOL_H__
+
+#include <stdint.h>
+#include "location_data.h"
+
+/**@brief Result of feeding a single byte to a protocol backend. */
+typedef enum GnssParseResult
+{
+    GNSS_PARSE_PENDING,     /**< Byte consumed, message not yet complete. */
+    GNSS_PARSE_LOCATION,    /**< Message complete, location record has been updated. */
+    GNSS_PARSE_IGNORED,     /**< Message complete and valid, but carries no new location. */
+    GNSS_PARSE_ERROR        /**< Message rejected, e.g. due to a checksum mismatch. */
+} GnssParseResultType;
+
+/**@brief Receiver status, as reported with the most recent verified message. */
+typedef struct GnssStatus
+{
+    uint8_t fix_type;       /**< LOCATION_FIX_NONE, LOCATION_FIX_VALID, LOCATION_FIX_2D or LOCATION_FIX_3D. */
+    uint8_t satellites;     /**< Number of satellites used. */
+} GnssStatusType;
+
+/**@brief Interface of a GNSS receiver protocol backend.
+ *
+ * @details Backends are fed byte by byte from the UART receive interrupt and keep their parser
+ *          state internally. The location record is only written once a message has been
+ *          verified, with the optional fields the protocol reports.
+ *          Backends which know the receiver status provide it by status, otherwise it is NULL.
+ */
+typedef struct GnssProtocol
+{
+    void (*reset)(void);
+    GnssParseResultType (*parse)(uint8_t c, LocationRecordType *record);
+    void (*status)(GnssStatusType *status);
+} GnssProtocolType;
+
+#endif // GNSS_PROTOCOL_H__
\ No newline at end of file
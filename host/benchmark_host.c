@@ -0,0 +1,290 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "location_data.h"
+#include "location_parser.h"
+#include "benchmark_reference.h"
+
+#define BENCHMARK_ITERATIONS        2000000UL   /**< Calls per measurement. */
+#define BENCHMARK_RUNS              5U          /**< Measurements, the fastest one is reported. */
+#define COMPARE_LINES               3000000UL   /**< Random lines compared against the reference. */
+#define COMPARE_MAX_LENGTH          24U
+#define COMPARE_LOCATIONS           5000000UL   /**< Random locations serialized by both implementations. */
+#define SERIALIZED_SIZE             (LATITUDE_MAX_DATA_SIZE + LONGITUDE_MAX_DATA_SIZE + 1U)
+#if defined(__x86_64__) || defined(__i386__)
+#define COUNTER_UNIT                "cycles"    /**< Time stamp counter. */
+#else
+#define COUNTER_UNIT                "ns"        /**< Monotonic clock. */
+#endif
+
+/*
+ * Host benchmark of the location parser and serializer against the superseded implementations
+ * in benchmark_reference.c, see README.md.
+ */
+
+static const char * const sample_line[] =
+{
+    "-12.345678,+123.456789",
+    "0.123456,0.123456",
+    "-.123456,.123456",
+    "+90.000000,+180.000000",
+    "-90.000000,-180.000000",
+    "45.999999,-179.999999",
+    "12.34567,1.000000",
+    "ab.cdefgh,1"
+};
+
+static const LocationDataType sample_location[] =
+{
+    { .latitude =  53361337L, .longitude =   -6505620L },
+    { .latitude = -90000000L, .longitude = -180000000L },
+    { .latitude =    123456L, .longitude =  123456789L },
+    { .latitude =  -1000001L, .longitude =    9999999L }
+};
+
+#define SAMPLE_COUNT    (sizeof(sample_line) / sizeof(sample_line[0U]))
+#define LOCATION_COUNT  (sizeof(sample_location) / sizeof(sample_location[0U]))
+
+static volatile int32_t sink;
+
+// Private method declarations
+static uint64_t counter_get(void);
+static void parse_compare(void);
+static void parse_benchmark(void);
+static bool serialize_equal(const LocationDataType *location);
+static void serialize_compare(void);
+static void serialize_benchmark(void);
+
+int main(void)
+{
+    printf("Unit: %s, parser: %s\n", COUNTER_UNIT, LOCATION_PARSER_SWAR ? "SWAR" : "bytewise");
+
+    parse_compare();
+    parse_benchmark();
+    serialize_compare();
+    serialize_benchmark();
+
+    return 0;
+}
+
+/*
+ * Private methods
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+static uint64_t counter_get(void)
+{
+    return __rdtsc();
+}
+#else
+static uint64_t counter_get(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+}
+#endif
+
+/**@brief Compares the parser with the reference on random lines.
+ *
+ * @details The reference accepts latitudes above 90 and wraps degrees of four digit longitudes
+ *          in uint8_t, so some lines it accepts are expected to be rejected by the parser.
+ */
+static void parse_compare(void)
+{
+    static const char alphabet[] = "0123456789+-.,9";
+    uint32_t reference_only = 0UL;
+    uint32_t parser_only = 0UL;
+    uint32_t different = 0UL;
+
+    srand(1U);
+    for (uint32_t line = 0UL; line < COMPARE_LINES; ++line)
+    {
+        uint8_t buffer[COMPARE_MAX_LENGTH];
+        uint8_t length = (uint8_t)((rand() % COMPARE_MAX_LENGTH) + 1);
+        ReferenceLocationType reference;
+        LocationDataType expected;
+        LocationDataType location;
+        bool reference_valid;
+        bool parser_valid;
+
+        for (uint8_t idx = 0U; idx < length; ++idx)
+        {
+            buffer[idx] = alphabet[rand() % (sizeof(alphabet) - 1U)];
+        }
+
+        reference_valid = reference_validate_location_data(buffer, length, &reference);
+        parser_valid = (LOCATION_PARSE_SUCCESS == location_parser_parse(buffer, length, &location, NULL));
+
+        if (reference_valid && !parser_valid)
+        {
+            reference_only++;
+        }
+        else if (!reference_valid && parser_valid)
+        {
+            parser_only++;
+        }
+        else if (reference_valid)
+        {
+            reference_set_location_data(buffer, length, &reference);
+            reference_location_to_data(&reference, &expected);
+            if ((expected.latitude != location.latitude) || (expected.longitude != location.longitude))
+            {
+                different++;
+            }
+        }
+    }
+
+    printf("Parse: %lu random lines, accepted by reference only %lu, by parser only %lu, different %lu\n",
+           (unsigned long)COMPARE_LINES, (unsigned long)reference_only, (unsigned long)parser_only,
+           (unsigned long)different);
+}
+
+/**@brief Measures validate and set of the reference against the parser on a mix of valid and
+ *        invalid lines.
+ */
+static void parse_benchmark(void)
+{
+    uint8_t length[SAMPLE_COUNT];
+    uint64_t reference_best = UINT64_MAX;
+    uint64_t parser_best = UINT64_MAX;
+
+    for (uint8_t idx = 0U; idx < SAMPLE_COUNT; ++idx)
+    {
+        length[idx] = (uint8_t)strlen(sample_line[idx]);
+    }
+
+    for (uint8_t run = 0U; run < BENCHMARK_RUNS; ++run)
+    {
+        ReferenceLocationType reference;
+        LocationDataType location;
+        uint64_t start;
+        uint64_t elapsed;
+
+        start = counter_get();
+        for (uint32_t idx = 0UL; idx < BENCHMARK_ITERATIONS; ++idx)
+        {
+            const uint8_t *line = (const uint8_t *)sample_line[idx % SAMPLE_COUNT];
+
+            if (reference_validate_location_data(line, length[idx % SAMPLE_COUNT], &reference))
+            {
+                reference_set_location_data(line, length[idx % SAMPLE_COUNT], &reference);
+            }
+            sink += (int32_t)reference.latitude.decimal;
+        }
+        elapsed = counter_get() - start;
+        reference_best = (elapsed < reference_best) ? elapsed : reference_best;
+
+        start = counter_get();
+        for (uint32_t idx = 0UL; idx < BENCHMARK_ITERATIONS; ++idx)
+        {
+            (void)location_parser_parse((const uint8_t *)sample_line[idx % SAMPLE_COUNT], length[idx % SAMPLE_COUNT],
+                                        &location, NULL);
+            sink += location.latitude;
+        }
+        elapsed = counter_get() - start;
+        parser_best = (elapsed < parser_best) ? elapsed : parser_best;
+    }
+
+    printf("Parse: reference %.1f, parser %.1f %s per line\n",
+           (double)reference_best / BENCHMARK_ITERATIONS, (double)parser_best / BENCHMARK_ITERATIONS, COUNTER_UNIT);
+}
+
+/**@brief Serializes a location with the reference and the current serializer.
+ *
+ * @returns true if both wrote the same characters.
+ */
+static bool serialize_equal(const LocationDataType *location)
+{
+    ReferenceLocationType reference;
+    uint8_t expected[SERIALIZED_SIZE];
+    uint8_t serialized[SERIALIZED_SIZE];
+
+    reference_location_from_data(location, &reference);
+    reference_location_serialize(&reference, expected, sizeof(expected));
+    location_data_serialize(location, serialized, sizeof(serialized));
+
+    return (0 == memcmp(expected, serialized, LATITUDE_MAX_DATA_SIZE + LONGITUDE_MAX_DATA_SIZE + 1U));
+}
+
+/**@brief Compares the serializer with the reference on the range limits and random locations. */
+static void serialize_compare(void)
+{
+    static const int32_t limits[] = { 0L, 1L, -1L, 999999L, -999999L, 1000000L, -1000000L };
+    uint32_t different = 0UL;
+
+    for (uint8_t idx = 0U; idx < (sizeof(limits) / sizeof(limits[0U])); ++idx)
+    {
+        LocationDataType location[] =
+        {
+            { .latitude = limits[idx], .longitude = limits[idx] },
+            { .latitude = LATITUDE_MAX - limits[idx], .longitude = LONGITUDE_MAX - limits[idx] },
+            { .latitude = limits[idx] - LATITUDE_MAX, .longitude = limits[idx] - LONGITUDE_MAX }
+        };
+
+        for (uint8_t limit = 0U; limit < (sizeof(location) / sizeof(location[0U])); ++limit)
+        {
+            different += serialize_equal(&location[limit]) ? 0UL : 1UL;
+        }
+    }
+
+    srand(2U);
+    for (uint32_t count = 0UL; count < COMPARE_LOCATIONS; ++count)
+    {
+        LocationDataType location;
+
+        location.latitude = (int32_t)(((uint32_t)rand() % (2UL * LATITUDE_MAX + 1UL))) - LATITUDE_MAX;
+        location.longitude = (int32_t)(((uint32_t)rand() % (2UL * LONGITUDE_MAX + 1UL))) - LONGITUDE_MAX;
+        different += serialize_equal(&location) ? 0UL : 1UL;
+    }
+
+    printf("Serialize: %lu random locations and range limits, different %lu\n",
+           (unsigned long)COMPARE_LOCATIONS, (unsigned long)different);
+}
+
+/**@brief Measures the reference serializer against the current one. */
+static void serialize_benchmark(void)
+{
+    ReferenceLocationType reference[LOCATION_COUNT];
+    uint8_t serialized[SERIALIZED_SIZE];
+    uint64_t reference_best = UINT64_MAX;
+    uint64_t serializer_best = UINT64_MAX;
+
+    // The reference stores sign, degrees and decimal, converting is not part of its cost
+    for (uint8_t idx = 0U; idx < LOCATION_COUNT; ++idx)
+    {
+        reference_location_from_data(&sample_location[idx], &reference[idx]);
+    }
+
+    for (uint8_t run = 0U; run < BENCHMARK_RUNS; ++run)
+    {
+        uint64_t start;
+        uint64_t elapsed;
+
+        start = counter_get();
+        for (uint32_t idx = 0UL; idx < BENCHMARK_ITERATIONS; ++idx)
+        {
+            reference_location_serialize(&reference[idx % LOCATION_COUNT], serialized, sizeof(serialized));
+            sink += serialized[idx % SERIALIZED_SIZE];
+        }
+        elapsed = counter_get() - start;
+        reference_best = (elapsed < reference_best) ? elapsed : reference_best;
+
+        start = counter_get();
+        for (uint32_t idx = 0UL; idx < BENCHMARK_ITERATIONS; ++idx)
+        {
+            location_data_serialize(&sample_location[idx % LOCATION_COUNT], serialized, sizeof(serialized));
+            sink += serialized[idx % SERIALIZED_SIZE];
+        }
+        elapsed = counter_get() - start;
+        serializer_best = (elapsed < serializer_best) ? elapsed : serializer_best;
+    }
+
+    printf("Serialize: reference %.1f, serializer %.1f %s per call\n",
+           (double)reference_best / BENCHMARK_ITERATIONS, (double)serializer_best / BENCHMARK_ITERATIONS, COUNTER_UNIT);
+}
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "beacon_payload.h"
+#include "beacon_payload_decode.h"
+#include "beacon_crypto.h"
+
+#define ROUND_TRIPS                 200000UL    /**< Random tracks encoded and decoded again. */
+#define TRACK_MAX_FIXES             (2U * BEACON_TRACK_SIZE)
+#define CAPACITY_MIN                BEACON_PAYLOAD_LENGTH
+#define CAPACITY_MAX                UINT8_MAX
+
+/*
+ * Host round trip check of the payload encoder in the format selected by BEACON_PAYLOAD_FORMAT
+ * and the reference decoder, see README.md.
+ *
+ * The crypto functions below stand in for beacon_crypto.c, which needs the AES ECB peripheral.
+ * They are no cipher, they only check that encoder and decoder agree on nonce, encrypted data
+ * and MAC.
+ */
+
+static const BeaconPayloadCryptoType crypto =
+{
+    .ctr = beacon_crypto_ctr,
+    .mac_verify = beacon_crypto_mac_verify
+};
+
+static uint32_t counter;
+
+// Private method declarations
+static int32_t random_coordinate(int32_t limit);
+static bool round_trip(const BeaconTrackType *track, uint8_t sequence, uint8_t capacity);
+
+int main(void)
+{
+    BeaconTrackType track;
+    uint32_t mismatches = 0UL;
+
+    srand(1U);
+    for (uint32_t trip = 0UL; trip < ROUND_TRIPS; ++trip)
+    {
+        uint8_t fixes = (uint8_t)(rand() % (TRACK_MAX_FIXES + 1U));
+        uint8_t capacity = (uint8_t)(CAPACITY_MIN + (rand() % (CAPACITY_MAX - CAPACITY_MIN + 1U)));
+        uint32_t time = (uint32_t)rand();
+        LocationDataType location;
+
+        // Leaves room for the steps below, the ASCII format only takes valid coordinates
+        location.latitude = random_coordinate(LATITUDE_MAX / 2);
+        location.longitude = random_coordinate(LONGITUDE_MAX / 2);
+
+        beacon_track_init(&track);
+        for (uint8_t fix = 0U; fix < fixes; ++fix)
+        {
+            // Mostly small steps, sometimes a jump
+            int32_t step = (0 == (rand() % 8)) ? 100000 : 100;
+
+            location.latitude += (rand() % (2 * step + 1)) - step;
+            location.longitude += (rand() % (2 * step + 1)) - step;
+            time += (uint32_t)(rand() % 1000);
+            beacon_track_add(&track, &location, time);
+        }
+
+        if (!round_trip(&track, (uint8_t)trip, capacity))
+        {
+            mismatches++;
+        }
+    }
+
+    printf("Payload format %u: %lu round trips, %lu mismatches\n", BEACON_PAYLOAD_FORMAT,
+           (unsigned long)ROUND_TRIPS, (unsigned long)mismatches);
+
+    return (0UL == mismatches) ? 0 : 1;
+}
+
+void beacon_crypto_nonce_next(uint8_t *nonce)
+{
+    ++counter;
+
+    memset(nonce, 0xA5, BEACON_CRYPTO_NONCE_LENGTH / 2U);
+    nonce[4U] = (uint8_t)counter;
+    nonce[5U] = (uint8_t)(counter >> 8);
+    nonce[6U] = (uint8_t)(counter >> 16);
+    nonce[7U] = (uint8_t)(counter >> 24);
+}
+
+void beacon_crypto_ctr(const uint8_t *nonce, uint8_t *data, uint8_t length)
+{
+    for (uint8_t idx = 0U; idx < length; ++idx)
+    {
+        data[idx] ^= (uint8_t)(nonce[idx % BEACON_CRYPTO_NONCE_LENGTH] + idx);
+    }
+}
+
+void beacon_crypto_mac(const uint8_t *data, uint8_t length, uint8_t *mac)
+{
+    memset(mac, 0, BEACON_CRYPTO_MAC_LENGTH);
+    for (uint8_t idx = 0U; idx < length; ++idx)
+    {
+        mac[idx % BEACON_CRYPTO_MAC_LENGTH] = (uint8_t)((mac[idx % BEACON_CRYPTO_MAC_LENGTH] * 31U) + data[idx]);
+    }
+}
+
+bool beacon_crypto_mac_verify(const uint8_t *data, uint8_t length, const uint8_t *mac)
+{
+    uint8_t expected[BEACON_CRYPTO_MAC_LENGTH];
+
+    beacon_crypto_mac(data, length, expected);
+
+    return (0 == memcmp(expected, mac, BEACON_CRYPTO_MAC_LENGTH));
+}
+
+/*
+ * Private methods
+ */
+
+/**@brief Returns a random coordinate within +/- limit micro-degrees. */
+static int32_t random_coordinate(int32_t limit)
+{
+    int32_t value = (int32_t)((((uint32_t)rand() << 16) ^ (uint32_t)rand()) % (2U * (uint32_t)limit + 1U));
+
+    return value - limit;
+}
+
+/**@brief Encodes the track and checks that the decoder returns the encoded fixes.
+ *
+ * @details ASCII, binary and secure format carry the newest fix. The track format carries the
+ *          newest fixes as far as they fit into the capacity, at least the newest one.
+ *
+ * @returns true if the decoded payload matches the track.
+ */
+static bool round_trip(const BeaconTrackType *track, uint8_t sequence, uint8_t capacity)
+{
+    uint8_t buffer[CAPACITY_MAX];
+    BeaconPayloadType payload;
+    uint8_t length = beacon_payload_encode(track, sequence, buffer, capacity);
+    uint8_t expected_count = (track->count > 0U) ? 1U : 0U;
+    uint8_t fix = track->newest;
+
+    if ((length > capacity) || !beacon_payload_decode(buffer, length, &crypto, &payload))
+    {
+        return false;
+    }
+
+#if (BEACON_PAYLOAD_FORMAT == BEACON_PAYLOAD_TRACK)
+    if ((payload.count < expected_count) || (payload.count > track->count))
+    {
+        return false;
+    }
+    expected_count = payload.count;
+    if (payload.sequence != sequence)
+    {
+        return false;
+    }
+#else
+    // Without a fix the other formats carry the initial location
+    expected_count = 1U;
+#if (BEACON_PAYLOAD_FORMAT == BEACON_PAYLOAD_SECURE)
+    if (payload.sequence != (uint8_t)counter)
+    {
+        return false;
+    }
+#elif (BEACON_PAYLOAD_FORMAT == BEACON_PAYLOAD_BINARY)
+    if (payload.sequence != sequence)
+    {
+        return false;
+    }
+#endif
+#endif
+
+    if (payload.count != expected_count)
+    {
+        return false;
+    }
+
+#if (BEACON_PAYLOAD_FORMAT != BEACON_PAYLOAD_ASCII)
+    if (((track->count > 0U) ? BEACON_PAYLOAD_FLAG_FIX_VALID : 0U) != payload.flags)
+    {
+        return false;
+    }
+#endif
+
+    for (uint8_t idx = 0U; (idx < track->count) && (idx < payload.count); ++idx)
+    {
+        const BeaconFixType * expected = &track->fix[fix];
+
+        if ((expected->location.latitude != payload.fix[idx].location.latitude) ||
+            (expected->location.longitude != payload.fix[idx].location.longitude) ||
+            ((track->fix[track->newest].time - expected->time) != payload.fix[idx].time))
+        {
+            return false;
+        }
+        fix = (fix - 1U) & (BEACON_TRACK_SIZE - 1U);
+    }
+
+    return true;
+}
\ No newline at end of file
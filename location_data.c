@@ -0,0 +1,229 @@
+#include <stdbool.h>
+#include <math.h>
+#include "location_data.h"
+
+#define DECIMAL_PRECISION           6U          /**< Decimal precision of location data. */
+#define DAYS_TO_2000                730425UL    /**< Day number of 2000-01-01 in the March based calendar below. */
+#define RADIANS_PER_MICRO_DEGREE    1.74532925e-8f
+
+/**@brief ASCII digit pairs "00" to "99". */
+static const char digit_pairs[200U] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// Private method declarations
+static void coordinate_serialize(int32_t micro_degrees, bool three_digit_degrees, uint8_t *buffer);
+static uint8_t * write_digit_pair(uint8_t *buffer, uint32_t value);
+static inline uint32_t div_1000000(uint32_t value);
+static inline uint32_t div_10000(uint32_t value);
+static inline uint32_t div_100(uint32_t value);
+
+/*
+ * Public methods
+ */
+
+/**@brief Set location data to default values. */
+void location_data_init(LocationDataType *location_data)
+{
+    location_data->latitude  = 0L;
+    location_data->longitude = 0L;
+}
+
+/**@brief Sets a location record to a valid fix without optional fields. */
+void location_record_init(LocationRecordType *record)
+{
+    location_data_init(&record->position);
+    record->altitude   = 0L;
+    record->time       = 0UL;
+    record->date       = 0U;
+    record->speed      = 0U;
+    record->course     = 0U;
+    record->hdop       = 0U;
+    record->pdop       = 0U;
+    record->satellites = 0U;
+    record->fix_type   = LOCATION_FIX_VALID;
+    record->fields     = 0U;
+}
+
+/**@brief Converts a date from 2000-01-01 on to the number of days since then.
+ *
+ * @details The year is shifted to start in March, so the leap day is the last day of the year
+ *          and the days before each month follow from a linear formula.
+ *
+ * @param[in]   year    Year, 2000 or later.
+ * @param[in]   month   Month, 1 to 12.
+ * @param[in]   day     Day of month, 1 to 31.
+ *
+ * @returns Days since 2000-01-01.
+ */
+uint16_t location_date_to_days(uint16_t year, uint8_t month, uint8_t day)
+{
+    uint32_t y = (month <= 2U) ? (year - 1U) : year;
+    uint32_t m = (month <= 2U) ? (month + 9U) : (month - 3U);
+    uint32_t days = (365UL * y) + (y / 4U) - (y / 100U) + (y / 400U) + (((153U * m) + 2U) / 5U) + day - 1U;
+
+    return (uint16_t)(days - DAYS_TO_2000);
+}
+
+/**@brief Returns the cosine of a latitude, scales longitude differences to latitude distance.
+ *
+ * @details Fixed point with LONGITUDE_SCALE_SHIFT fractional bits. Computed once per reference
+ *          position instead of per fix.
+ *
+ * @param[in]   latitude    Latitude in micro-degrees.
+ */
+int32_t location_longitude_scale(int32_t latitude)
+{
+    float latitude_rad = (float)latitude * RADIANS_PER_MICRO_DEGREE;
+
+    return (int32_t)(cosf(latitude_rad) * (float)(1UL << LONGITUDE_SCALE_SHIFT));
+}
+
+/**@brief Computes the difference between two positions in micro-degrees per axis.
+ *
+ * @details The longitude difference takes the shortest way across the antimeridian.
+ *
+ * @param[in]   from        Reference position.
+ * @param[in]   to          Position.
+ * @param[out]  dlat        Latitude difference, positive north.
+ * @param[out]  dlon        Longitude difference, positive east.
+ */
+void location_delta(const LocationDataType *from, const LocationDataType *to, int32_t *dlat, int32_t *dlon)
+{
+    int64_t delta = (int64_t)to->longitude - from->longitude;
+
+    if (delta > LONGITUDE_MAX)
+    {
+        delta -= 2L * LONGITUDE_MAX;
+    }
+    else if (delta < -LONGITUDE_MAX)
+    {
+        delta += 2L * LONGITUDE_MAX;
+    }
+
+    *dlat = to->latitude - from->latitude;
+    *dlon = (int32_t)delta;
+}
+
+/**@brief Computes the squared distance between two positions.
+ *
+ * @details Equirectangular approximation in micro-degrees of latitude, accurate enough for
+ *          distances of a few meters. Squared distances avoid the square root.
+ *
+ * @param[in]   from            Reference position.
+ * @param[in]   to              Position.
+ * @param[in]   longitude_scale Longitude scale of the reference position, see
+ *                              @ref location_longitude_scale.
+ *
+ * @returns Squared distance in micro-degrees of latitude.
+ */
+int64_t location_distance_squared(const LocationDataType *from, const LocationDataType *to, int32_t longitude_scale)
+{
+    int32_t dlat;
+    int32_t dlon;
+    int64_t scaled_dlon;
+
+    location_delta(from, to, &dlat, &dlon);
+    scaled_dlon = ((int64_t)dlon * longitude_scale) / (1L << LONGITUDE_SCALE_SHIFT);
+
+    return ((int64_t)dlat * dlat) + (scaled_dlon * scaled_dlon);
+}
+
+/**@brief Converts a coordinate given by sign, degrees and decimal to micro-degrees. */
+int32_t coordinate_to_micro_degrees(const CoordinateType *coordinate)
+{
+    int32_t magnitude = ((int32_t)coordinate->degrees * MICRO_DEGREES_PER_DEGREE) + (int32_t)coordinate->decimal;
+
+    return (coordinate->sign < 0) ? -magnitude : magnitude;
+}
+
+/**@brief Splits a coordinate in micro-degrees into sign, degrees and decimal. */
+void coordinate_from_micro_degrees(CoordinateType *coordinate, int32_t micro_degrees)
+{
+    uint32_t magnitude = (micro_degrees < 0) ? -(uint32_t)micro_degrees : (uint32_t)micro_degrees;
+
+    coordinate->sign    = (micro_degrees < 0) ? -1 : 1;
+    coordinate->degrees = magnitude / MICRO_DEGREES_PER_DEGREE;
+    coordinate->decimal = magnitude % MICRO_DEGREES_PER_DEGREE;
+}
+
+/**@brief Converts location data to string
+ *
+ * @details Writes the fixed width format "+DD.DDDDDD,+DDD.DDDDDD" two digits at a time from a
+ *          digit pair table. Quotients are computed by multiplication with reciprocals, no
+ *          division is needed.
+ */
+void location_data_serialize(const LocationDataType *location_data, uint8_t *buffer, uint8_t buffer_size)
+{
+    if (buffer_size >= (LATITUDE_MAX_DATA_SIZE + LONGITUDE_MAX_DATA_SIZE + 1U))
+    {
+        coordinate_serialize(location_data->latitude, false, &buffer[0U]);
+        buffer[LATITUDE_MAX_DATA_SIZE] = ',';
+        coordinate_serialize(location_data->longitude, true, &buffer[LATITUDE_MAX_DATA_SIZE + 1U]);
+    }
+}
+
+/*
+ * Private methods
+ */
+
+/**@brief Writes a coordinate as sign, 2 or 3 degree digits, '.' and DECIMAL_PRECISION digits. */
+static void coordinate_serialize(int32_t micro_degrees, bool three_digit_degrees, uint8_t *buffer)
+{
+    uint32_t magnitude = (micro_degrees < 0) ? -(uint32_t)micro_degrees : (uint32_t)micro_degrees;
+    uint32_t degrees = div_1000000(magnitude);
+    uint32_t decimal = magnitude - (degrees * MICRO_DEGREES_PER_DEGREE);
+    uint32_t decimal_high = div_10000(decimal);
+    uint32_t decimal_low = decimal - (decimal_high * 10000UL);
+    uint32_t decimal_mid = div_100(decimal_low);
+
+    *buffer++ = (micro_degrees < 0) ? '-' : '+';
+
+    if (three_digit_degrees)
+    {
+        uint32_t hundreds = div_100(degrees);
+
+        *buffer++ = '0' + hundreds;
+        degrees -= hundreds * 100U;
+    }
+    buffer = write_digit_pair(buffer, degrees);
+
+    *buffer++ = '.';
+    buffer = write_digit_pair(buffer, decimal_high);
+    buffer = write_digit_pair(buffer, decimal_mid);
+    (void)write_digit_pair(buffer, decimal_low - (decimal_mid * 100U));
+}
+
+static uint8_t * write_digit_pair(uint8_t *buffer, uint32_t value)
+{
+    buffer[0U] = digit_pairs[2U * value];
+    buffer[1U] = digit_pairs[(2U * value) + 1U];
+
+    return &buffer[2U];
+}
+
+/**@brief Divides by 10^6, exact for values up to 181 * 10^6. */
+static inline uint32_t div_1000000(uint32_t value)
+{
+    return (uint32_t)(((uint64_t)value * 1125899907ULL) >> 50);
+}
+
+/**@brief Divides by 10^4, exact for values below 10^6. */
+static inline uint32_t div_10000(uint32_t value)
+{
+    return (uint32_t)(((uint64_t)value * 429497ULL) >> 32);
+}
+
+/**@brief Divides by 100, exact for values below 10^4. */
+static inline uint32_t div_100(uint32_t value)
+{
+    return (value * 5243UL) >> 19;
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#ifndef LOCATION_DATA_H__
+#define LOCATION_DATA_H__
+
+#include <stdint.h>
+
+#define LATITUDE_MAX_DATA_SIZE      10U         /**< Maximum length of received latitude data. */
+#define LONGITUDE_MAX_DATA_SIZE     11U         /**< Maximum length of received longitude data. */
+
+#define MICRO_DEGREES_PER_DEGREE    1000000L    /**< Scale of location data. */
+#define LATITUDE_MAX                (90L * MICRO_DEGREES_PER_DEGREE)    /**< Maximum absolute latitude in micro-degrees. */
+#define LONGITUDE_MAX               (180L * MICRO_DEGREES_PER_DEGREE)   /**< Maximum absolute longitude in micro-degrees. */
+#define METERS_PER_DEGREE           111195L     /**< Length of a degree of latitude on a spherical earth. */
+#define LONGITUDE_SCALE_SHIFT       15U         /**< Fixed point precision of the longitude scale. */
+
+#define LOCATION_FIX_NONE           0U          /**< No position fix. */
+#define LOCATION_FIX_VALID          1U          /**< Valid fix, dimension not reported by the receiver. */
+#define LOCATION_FIX_2D             2U          /**< 2D fix. */
+#define LOCATION_FIX_3D             3U          /**< 3D fix. */
+
+#define LOCATION_FIELD_ALTITUDE     0x01U       /**< Optional fields of the location record, set if valid. */
+#define LOCATION_FIELD_SPEED        0x02U
+#define LOCATION_FIELD_COURSE       0x04U
+#define LOCATION_FIELD_HDOP         0x08U
+#define LOCATION_FIELD_PDOP         0x10U
+#define LOCATION_FIELD_SATELLITES   0x20U
+#define LOCATION_FIELD_TIME         0x40U
+#define LOCATION_FIELD_DATE         0x80U
+
+/**@brief Coordinate split into sign, degrees and 6-digit decimal, as used in location lines. */
+typedef struct Coordinate
+{
+    int8_t sign;
+    uint8_t degrees;
+    uint32_t decimal;
+} CoordinateType;
+
+/**@brief Location in signed micro-degrees, can be compared and subtracted directly. */
+typedef struct LocationData
+{
+    int32_t latitude;       /**< Latitude in micro-degrees, positive north. */
+    int32_t longitude;      /**< Longitude in micro-degrees, positive east. */
+} LocationDataType;
+
+/**@brief Fix as reported by the receiver, 32 bytes.
+ *
+ * @details The position comes first, so subscribers only interested in latitude and longitude
+ *          are passed a pointer to it. Optional fields are only valid if their LOCATION_FIELD
+ *          flag is set, as not every receiver protocol reports all of them.
+ */
+typedef struct LocationRecord
+{
+    LocationDataType position;
+    int32_t altitude;       /**< Altitude above mean sea level in mm. */
+    uint32_t time;          /**< UTC time of day in ms. */
+    uint16_t date;          /**< UTC date in days since 2000-01-01. */
+    uint16_t speed;         /**< Ground speed in cm/s. */
+    uint16_t course;        /**< Course over ground in 0.01 degrees, 0 to 35999. */
+    uint16_t hdop;          /**< Horizontal dilution of precision in 0.01. */
+    uint16_t pdop;          /**< Position dilution of precision in 0.01. */
+    uint8_t satellites;     /**< Satellites used. */
+    uint8_t fix_type;       /**< LOCATION_FIX_NONE, LOCATION_FIX_VALID, LOCATION_FIX_2D or LOCATION_FIX_3D. */
+    uint8_t fields;         /**< LOCATION_FIELD flags of the valid optional fields. */
+} LocationRecordType;
+
+void location_data_init(LocationDataType* location_data);
+void location_record_init(LocationRecordType *record);
+uint16_t location_date_to_days(uint16_t year, uint8_t month, uint8_t day);
+int32_t location_longitude_scale(int32_t latitude);
+void location_delta(const LocationDataType *from, const LocationDataType *to, int32_t *dlat, int32_t *dlon);
+int64_t location_distance_squared(const LocationDataType *from, const LocationDataType *to, int32_t longitude_scale);
+int32_t coordinate_to_micro_degrees(const CoordinateType *coordinate);
+void coordinate_from_micro_degrees(CoordinateType *coordinate, int32_t micro_degrees);
+void location_data_serialize(const LocationDataType* location_data, uint8_t *buffer, uint8_t buffer_size);
+
+#endif // LOCATION_DATA_H__
\ No newline at end of file
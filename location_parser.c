@@ -0,0 +1,459 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "location_parser.h"
+#if LOCATION_PARSER_SWAR && defined(__ARM_FEATURE_SIMD32)
+#include "nrf.h"
+#endif
+
+#define MAX_ABS_LATITUDE           90U  /**< Maximum absolute latitude */
+#define MAX_ABS_LONGITUDE         180U  /**< Maximum absolute longitude */
+#define FRACTION_DIGITS             6U  /**< Number of fractional digits of a coordinate. */
+
+#define SWAR_ASCII_ZEROS    0x30303030UL    /**< '0' in each byte. */
+#define SWAR_NINES          0x09090909UL
+
+/**@brief Character classes of the location line. */
+typedef enum CharClass
+{
+    CLASS_OTHER,
+    CLASS_DIGIT,
+    CLASS_PLUS,
+    CLASS_MINUS,
+    CLASS_DOT,
+    CLASS_COMMA,
+    CLASS_COUNT
+} CharClassType;
+
+/**@brief States of the location line DFA.
+ *
+ * @details Latitude and longitude use the same sequence of states. Each integer and fractional
+ *          digit position has its own state, so the number of digits is checked by the table.
+ */
+typedef enum ParserState
+{
+    STATE_LAT_START,
+    STATE_LAT_SIGN,
+    STATE_LAT_INT_1,
+    STATE_LAT_INT_2,
+    STATE_LAT_INT_3,
+    STATE_LAT_FRAC_0,
+    STATE_LAT_FRAC_1,
+    STATE_LAT_FRAC_2,
+    STATE_LAT_FRAC_3,
+    STATE_LAT_FRAC_4,
+    STATE_LAT_FRAC_5,
+    STATE_LAT_FRAC_6,
+    STATE_LON_START,
+    STATE_LON_SIGN,
+    STATE_LON_INT_1,
+    STATE_LON_INT_2,
+    STATE_LON_INT_3,
+    STATE_LON_FRAC_0,
+    STATE_LON_FRAC_1,
+    STATE_LON_FRAC_2,
+    STATE_LON_FRAC_3,
+    STATE_LON_FRAC_4,
+    STATE_LON_FRAC_5,
+    STATE_LON_FRAC_6,
+    STATE_ERROR,
+    STATE_COUNT
+} ParserStateType;
+
+#define STATE_ACCEPT                STATE_LON_FRAC_6
+
+/**@brief Value accumulated by a digit, selected by the state entered.
+ *
+ * @details Degrees use even, decimals odd indices, the axis is given by index / 2.
+ */
+typedef enum ParserField
+{
+    FIELD_LAT_DEGREES,
+    FIELD_LAT_DECIMAL,
+    FIELD_LON_DEGREES,
+    FIELD_LON_DECIMAL,
+    FIELD_COUNT,
+    FIELD_NONE = FIELD_LAT_DEGREES  /**< Never read, states not entered by a digit. */
+} ParserFieldType;
+
+#define E   STATE_ERROR
+
+/**@brief Character class of each input byte. */
+static const uint8_t char_class[256U] =
+{
+    ['0'] = CLASS_DIGIT, ['1'] = CLASS_DIGIT, ['2'] = CLASS_DIGIT, ['3'] = CLASS_DIGIT, ['4'] = CLASS_DIGIT,
+    ['5'] = CLASS_DIGIT, ['6'] = CLASS_DIGIT, ['7'] = CLASS_DIGIT, ['8'] = CLASS_DIGIT, ['9'] = CLASS_DIGIT,
+    ['+'] = CLASS_PLUS, ['-'] = CLASS_MINUS, ['.'] = CLASS_DOT, [','] = CLASS_COMMA
+};
+
+/**@brief State transition table. */
+static const uint8_t transition[STATE_COUNT][CLASS_COUNT] =
+{
+    /*                   OTHER  DIGIT             PLUS             MINUS            DOT               COMMA */
+    [STATE_LAT_START]  = { E,   STATE_LAT_INT_1,  STATE_LAT_SIGN,  STATE_LAT_SIGN,  STATE_LAT_FRAC_0, E },
+    [STATE_LAT_SIGN]   = { E,   STATE_LAT_INT_1,  E,               E,               STATE_LAT_FRAC_0, E },
+    [STATE_LAT_INT_1]  = { E,   STATE_LAT_INT_2,  E,               E,               STATE_LAT_FRAC_0, E },
+    [STATE_LAT_INT_2]  = { E,   STATE_LAT_INT_3,  E,               E,               STATE_LAT_FRAC_0, E },
+    [STATE_LAT_INT_3]  = { E,   E,                E,               E,               STATE_LAT_FRAC_0, E },
+    [STATE_LAT_FRAC_0] = { E,   STATE_LAT_FRAC_1, E,               E,               E,                E },
+    [STATE_LAT_FRAC_1] = { E,   STATE_LAT_FRAC_2, E,               E,               E,                E },
+    [STATE_LAT_FRAC_2] = { E,   STATE_LAT_FRAC_3, E,               E,               E,                E },
+    [STATE_LAT_FRAC_3] = { E,   STATE_LAT_FRAC_4, E,               E,               E,                E },
+    [STATE_LAT_FRAC_4] = { E,   STATE_LAT_FRAC_5, E,               E,               E,                E },
+    [STATE_LAT_FRAC_5] = { E,   STATE_LAT_FRAC_6, E,               E,               E,                E },
+    [STATE_LAT_FRAC_6] = { E,   E,                E,               E,               E,                STATE_LON_START },
+    [STATE_LON_START]  = { E,   STATE_LON_INT_1,  STATE_LON_SIGN,  STATE_LON_SIGN,  STATE_LON_FRAC_0, E },
+    [STATE_LON_SIGN]   = { E,   STATE_LON_INT_1,  E,               E,               STATE_LON_FRAC_0, E },
+    [STATE_LON_INT_1]  = { E,   STATE_LON_INT_2,  E,               E,               STATE_LON_FRAC_0, E },
+    [STATE_LON_INT_2]  = { E,   STATE_LON_INT_3,  E,               E,               STATE_LON_FRAC_0, E },
+    [STATE_LON_INT_3]  = { E,   E,                E,               E,               STATE_LON_FRAC_0, E },
+    [STATE_LON_FRAC_0] = { E,   STATE_LON_FRAC_1, E,               E,               E,                E },
+    [STATE_LON_FRAC_1] = { E,   STATE_LON_FRAC_2, E,               E,               E,                E },
+    [STATE_LON_FRAC_2] = { E,   STATE_LON_FRAC_3, E,               E,               E,                E },
+    [STATE_LON_FRAC_3] = { E,   STATE_LON_FRAC_4, E,               E,               E,                E },
+    [STATE_LON_FRAC_4] = { E,   STATE_LON_FRAC_5, E,               E,               E,                E },
+    [STATE_LON_FRAC_5] = { E,   STATE_LON_FRAC_6, E,               E,               E,                E },
+    [STATE_LON_FRAC_6] = { E,   E,                E,               E,               E,                E },
+    [STATE_ERROR]      = { E,   E,                E,               E,               E,                E }
+};
+
+#undef E
+
+/**@brief Field accumulating the digit which led to each state. */
+static const uint8_t state_field[STATE_COUNT] =
+{
+    [STATE_LAT_START]  = FIELD_NONE,        [STATE_LAT_SIGN]   = FIELD_NONE,
+    [STATE_LAT_INT_1]  = FIELD_LAT_DEGREES, [STATE_LAT_INT_2]  = FIELD_LAT_DEGREES,
+    [STATE_LAT_INT_3]  = FIELD_LAT_DEGREES, [STATE_LAT_FRAC_0] = FIELD_NONE,
+    [STATE_LAT_FRAC_1] = FIELD_LAT_DECIMAL, [STATE_LAT_FRAC_2] = FIELD_LAT_DECIMAL,
+    [STATE_LAT_FRAC_3] = FIELD_LAT_DECIMAL, [STATE_LAT_FRAC_4] = FIELD_LAT_DECIMAL,
+    [STATE_LAT_FRAC_5] = FIELD_LAT_DECIMAL, [STATE_LAT_FRAC_6] = FIELD_LAT_DECIMAL,
+    [STATE_LON_START]  = FIELD_NONE,        [STATE_LON_SIGN]   = FIELD_NONE,
+    [STATE_LON_INT_1]  = FIELD_LON_DEGREES, [STATE_LON_INT_2]  = FIELD_LON_DEGREES,
+    [STATE_LON_INT_3]  = FIELD_LON_DEGREES, [STATE_LON_FRAC_0] = FIELD_NONE,
+    [STATE_LON_FRAC_1] = FIELD_LON_DECIMAL, [STATE_LON_FRAC_2] = FIELD_LON_DECIMAL,
+    [STATE_LON_FRAC_3] = FIELD_LON_DECIMAL, [STATE_LON_FRAC_4] = FIELD_LON_DECIMAL,
+    [STATE_LON_FRAC_5] = FIELD_LON_DECIMAL, [STATE_LON_FRAC_6] = FIELD_LON_DECIMAL,
+    [STATE_ERROR]      = FIELD_NONE
+};
+
+/**@brief Maximum absolute degrees, indexed by axis. */
+static const uint8_t max_degrees[2U] = { MAX_ABS_LATITUDE, MAX_ABS_LONGITUDE };
+
+static LocationParserType stream_parser;    /**< Context of the receive backend. */
+
+const GnssProtocolType location_protocol =
+{
+    .reset = location_parser_stream_reset,
+    .parse = location_parser_stream_parse
+};
+
+// Private method declarations
+static inline bool parser_step(LocationParserType *parser, uint8_t c);
+#if LOCATION_PARSER_SWAR
+static bool fraction_parse(LocationParserType *parser, const uint8_t *digits);
+static inline bool swar_digits_convert(uint32_t word, uint32_t *value);
+#endif
+static bool coordinate_in_range(uint32_t degrees, uint32_t decimal, uint8_t max);
+
+/*
+ * Public methods
+ */
+
+/**@brief Resets a parser context to the start of a line. */
+void location_parser_reset(LocationParserType *parser)
+{
+    parser->state = STATE_LAT_START;
+    parser->error = LOCATION_PARSE_SUCCESS;
+    parser->column = 0U;
+    parser->sign[0U] = 1;
+    parser->sign[1U] = 1;
+    for (uint8_t idx = 0U; idx < FIELD_COUNT; ++idx)
+    {
+        parser->value[idx] = 0UL;
+    }
+}
+
+/**@brief Feeds one byte of a location line to the parser.
+ *
+ * @details Each byte is classified and passed through a table driven DFA which checks the
+ *          syntax and the number of digits, while the digits are accumulated at the same time.
+ *          Input is rejected as soon as it cannot become valid anymore, e.g. degrees exceeding
+ *          the range or a nonzero fraction after 90 degrees latitude. Once rejected, further
+ *          bytes are ignored until the parser is reset.
+ *
+ * @param[in]   parser  Parser context.
+ * @param[in]   c       Next byte of the line, without CR/LF.
+ *
+ * @returns false if the line has been rejected, true otherwise.
+ */
+bool location_parser_feed(LocationParserType *parser, uint8_t c)
+{
+    return parser_step(parser, c);
+}
+
+/**@brief Completes parsing of a location line.
+ *
+ * @details Only checks the final state, all other work has been done while feeding.
+ *
+ * @param[in]   parser          Parser context.
+ * @param[out]  location        Parsed location data, only written if the line is valid.
+ * @param[out]  error_column    Zero based column of the first invalid byte, may be NULL.
+ *
+ * @returns LOCATION_PARSE_SUCCESS if the line is valid, error code otherwise.
+ */
+LocationParseErrorType location_parser_finish(const LocationParserType *parser,
+                                              LocationDataType *location, uint16_t *error_column)
+{
+    LocationParseErrorType error = parser->error;
+
+    if ((LOCATION_PARSE_SUCCESS == error) && (STATE_ACCEPT != parser->state))
+    {
+        error = LOCATION_PARSE_ERROR_INCOMPLETE;
+    }
+
+    if ((LOCATION_PARSE_SUCCESS == error) && (NULL != location))
+    {
+        int32_t latitude = (int32_t)((parser->value[FIELD_LAT_DEGREES] * MICRO_DEGREES_PER_DEGREE) +
+                                     parser->value[FIELD_LAT_DECIMAL]);
+        int32_t longitude = (int32_t)((parser->value[FIELD_LON_DEGREES] * MICRO_DEGREES_PER_DEGREE) +
+                                      parser->value[FIELD_LON_DECIMAL]);
+
+        location->latitude  = parser->sign[0U] * latitude;
+        location->longitude = parser->sign[1U] * longitude;
+    }
+
+    if (NULL != error_column)
+    {
+        *error_column = parser->column;
+    }
+
+    return error;
+}
+
+/**@brief Parses a complete location line.
+ *
+ * @details If LOCATION_PARSER_SWAR is set, the six fractional digits following '.' are checked
+ *          and converted a word at a time. If they are not all valid digits the bytes are fed
+ *          one by one instead, so the failing column is the same in both cases.
+ *
+ * @param[in]   buffer          Location line without CR/LF, e.g. "-12.345678,+123.456789".
+ * @param[in]   length          Length of the line.
+ * @param[out]  location        Parsed location data.
+ * @param[out]  error_column    Zero based column of the first invalid byte, may be NULL.
+ *
+ * @returns LOCATION_PARSE_SUCCESS if the line is valid, error code otherwise.
+ */
+LocationParseErrorType location_parser_parse(const uint8_t *buffer, uint16_t length,
+                                             LocationDataType *location, uint16_t *error_column)
+{
+    LocationParserType parser;
+
+    if ((NULL == buffer) || (NULL == location))
+    {
+        return LOCATION_PARSE_ERROR_INCOMPLETE;
+    }
+
+    location_parser_reset(&parser);
+
+    for (uint16_t column = 0U; column < length; ++column)
+    {
+        if (!parser_step(&parser, buffer[column]))
+        {
+            break;
+        }
+
+#if LOCATION_PARSER_SWAR
+        if (((STATE_LAT_FRAC_0 == parser.state) || (STATE_LON_FRAC_0 == parser.state)) &&
+            ((length - column - 1U) >= FRACTION_DIGITS) &&
+            fraction_parse(&parser, &buffer[column + 1U]))
+        {
+            column += FRACTION_DIGITS;
+        }
+#endif
+    }
+
+    return location_parser_finish(&parser, location, error_column);
+}
+
+/**@brief Resets the receive backend, any partially received line is discarded. */
+void location_parser_stream_reset(void)
+{
+    location_parser_reset(&stream_parser);
+}
+
+/**@brief Feeds one received byte to the receive backend.
+ *
+ * @details Parses location lines while they are received, so only the final state has to be
+ *          checked once CR or LF arrives. Empty lines are ignored. Location lines carry no
+ *          optional fields.
+ *
+ * @param[in]   c           Received byte.
+ * @param[out]  record      Location record updated at the end of a valid line.
+ *
+ * @returns Parse result, see @ref GnssParseResultType.
+ */
+GnssParseResultType location_parser_stream_parse(uint8_t c, LocationRecordType *record)
+{
+    GnssParseResultType result = GNSS_PARSE_PENDING;
+
+    if (('\r' == c) || ('\n' == c))
+    {
+        if ((stream_parser.column > 0U) || (LOCATION_PARSE_SUCCESS != stream_parser.error))
+        {
+            result = GNSS_PARSE_ERROR;
+            if (LOCATION_PARSE_SUCCESS == location_parser_finish(&stream_parser, &record->position, NULL))
+            {
+                record->fix_type = LOCATION_FIX_VALID;
+                record->fields = 0U;
+                result = GNSS_PARSE_LOCATION;
+            }
+        }
+        location_parser_reset(&stream_parser);
+    }
+    else
+    {
+        (void)location_parser_feed(&stream_parser, c);
+    }
+
+    return result;
+}
+
+/*
+ * Private methods
+ */
+
+/**@brief Advances the DFA by one byte, see location_parser_feed(). */
+static inline bool parser_step(LocationParserType *parser, uint8_t c)
+{
+    uint8_t char_type = char_class[c];
+    uint8_t state;
+
+    if (LOCATION_PARSE_SUCCESS != parser->error)
+    {
+        return false;
+    }
+
+    state = transition[parser->state][char_type];
+    parser->state = state;
+
+    if (STATE_ERROR == state)
+    {
+        parser->error = LOCATION_PARSE_ERROR_CHARACTER;
+        return false;
+    }
+
+    if (CLASS_DIGIT == char_type)
+    {
+        uint8_t field = state_field[state];
+        uint8_t axis = field >> 1;
+        uint32_t value = (parser->value[field] * 10U) + (c - '0');
+
+        parser->value[field] = value;
+
+        if (0U == (field & 1U))
+        {
+            // Degrees only grow with further digits
+            if (value > max_degrees[axis])
+            {
+                parser->error = LOCATION_PARSE_ERROR_RANGE;
+                return false;
+            }
+        }
+        else if (!coordinate_in_range(parser->value[field - 1U], value, max_degrees[axis]))
+        {
+            parser->error = LOCATION_PARSE_ERROR_RANGE;
+            return false;
+        }
+    }
+    else if (CLASS_MINUS == char_type)
+    {
+        parser->sign[(state >= STATE_LON_START) ? 1U : 0U] = -1;
+    }
+
+    ++parser->column;
+
+    return true;
+}
+
+static bool coordinate_in_range(uint32_t degrees, uint32_t decimal, uint8_t max)
+{
+    return (degrees < max) || ((degrees == max) && (0UL == decimal));
+}
+
+#if LOCATION_PARSER_SWAR
+/**@brief Checks and converts the six fractional digits following '.' at once.
+ *
+ * @details The digits are loaded as a word of four and a word of two digits, padded with leading
+ *          '0'. The parser is only advanced if all digits are valid and within range.
+ *
+ * @returns true if the parser has been advanced to the end of the fraction, false otherwise.
+ */
+static bool fraction_parse(LocationParserType *parser, const uint8_t *digits)
+{
+    uint8_t field = state_field[parser->state + 1U];
+    uint32_t word;
+    uint32_t high;
+    uint32_t low;
+
+    memcpy(&word, digits, sizeof(word));
+    if (!swar_digits_convert(word, &high))
+    {
+        return false;
+    }
+
+    word = ((uint32_t)digits[4U] << 16) | ((uint32_t)digits[5U] << 24) | (SWAR_ASCII_ZEROS & 0xFFFFUL);
+    if (!swar_digits_convert(word, &low))
+    {
+        return false;
+    }
+
+    low += high * 100U;
+    if (!coordinate_in_range(parser->value[field - 1U], low, max_degrees[field >> 1]))
+    {
+        return false;
+    }
+
+    parser->value[field] = low;
+    parser->state += FRACTION_DIGITS;
+    parser->column += FRACTION_DIGITS;
+
+    return true;
+}
+
+/**@brief Checks four ASCII digits in a little endian word and converts them to a value.
+ *
+ * @details On Cortex-M4 the check uses the SIMD instructions USUB8/SEL/UQSUB8: bytes below '0'
+ *          are saturated to 0xFF, then any byte left above 9 fails. Otherwise a portable bit trick
+ *          is used: adding 6 keeps the upper nibble at 3 for '0' to '9' only. The conversion
+ *          combines adjacent digits to pairs and the pairs to a value with two multiplications.
+ *
+ * @param[in]   word    Four characters, first character in the least significant byte.
+ * @param[out]  value   Converted value 0 to 9999.
+ *
+ * @returns true if all four characters are digits, false otherwise.
+ */
+static inline bool swar_digits_convert(uint32_t word, uint32_t *value)
+{
+    uint32_t digits;
+
+#if defined(__ARM_FEATURE_SIMD32)
+    digits = __USUB8(word, SWAR_ASCII_ZEROS);
+    if (0UL != __UQSUB8(__SEL(digits, 0xFFFFFFFFUL), SWAR_NINES))
+    {
+        return false;
+    }
+#else
+    if (((word & 0xF0F0F0F0UL) | (((word + 0x06060606UL) & 0xF0F0F0F0UL) >> 4)) != 0x33333333UL)
+    {
+        return false;
+    }
+    digits = word - SWAR_ASCII_ZEROS;
+#endif
+
+    digits = (digits * 10U) + (digits >> 8);
+    *value = ((digits & 0xFFU) * 100U) + ((digits >> 16) & 0xFFU);
+
+    return true;
+}
+#endif
\ No newline at end of file
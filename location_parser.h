@@ -0,0 +1,43 @@
+#ifndef LOCATION_PARSER_H__
+#define LOCATION_PARSER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "location_data.h"
+#include "gnss_protocol.h"
+
+#ifndef LOCATION_PARSER_SWAR
+#define LOCATION_PARSER_SWAR    1   /**< Check and convert fractional digits a word at a time. */
+#endif
+
+/**@brief Error codes of the location parser. */
+typedef enum LocationParseError
+{
+    LOCATION_PARSE_SUCCESS,             /**< Location data parsed successfully. */
+    LOCATION_PARSE_ERROR_CHARACTER,     /**< Unexpected character. */
+    LOCATION_PARSE_ERROR_RANGE,         /**< Latitude or longitude out of range. */
+    LOCATION_PARSE_ERROR_INCOMPLETE     /**< Line ended before location data was complete. */
+} LocationParseErrorType;
+
+/**@brief Resumable parser context, fed one byte at a time. */
+typedef struct LocationParser
+{
+    uint8_t state;
+    LocationParseErrorType error;   /**< First error detected, input is ignored afterwards. */
+    uint16_t column;                /**< Number of bytes consumed. */
+    int8_t sign[2U];
+    uint32_t value[4U];             /**< Degrees and decimal of latitude and longitude. */
+} LocationParserType;
+
+extern const GnssProtocolType location_protocol;
+
+void location_parser_reset(LocationParserType *parser);
+bool location_parser_feed(LocationParserType *parser, uint8_t c);
+LocationParseErrorType location_parser_finish(const LocationParserType *parser,
+                                              LocationDataType *location, uint16_t *error_column);
+LocationParseErrorType location_parser_parse(const uint8_t *buffer, uint16_t length,
+                                             LocationDataType *location, uint16_t *error_column);
+void location_parser_stream_reset(void);
+GnssParseResultType location_parser_stream_parse(uint8_t c, LocationRecordType *record);
+
+#endif // LOCATION_PARSER_H__
\ No newline at end of file
@@ -1,24 +1,83 @@
 #include <stdlib.h>
-#include <ctype.h>
+#include "nordic_common.h"
+#include "nrf.h"
+#include "app_error.h"
+#include "app_timer.h"
+#include "app_scheduler.h"
 #include "location_service.h"
+#include "location_parser.h"
 #include "gnss_handler.h"
 
-#define MAX_SUBSCRIBERS             5U  /**< Maximum number of clients that can subscribe to location server. */
-#define DECIMAL_PRECISION           6U  /**< Decimal precision of location data. */
-#define MAX_ABS_LATITUDE           90U  /**< Maximum absolute latitude */
-#define MAX_ABS_LONGITUDE         180U  /**< Maximum absolute longitude */
+#define MAX_SUBSCRIBERS             5U  /**< Maximum number of clients that can subscribe to location server, up to 8. */
+#define APP_TIMER_TICK_FREQ         (APP_TIMER_CLOCK_FREQ / (APP_TIMER_CONFIG_RTC_FREQUENCY + 1U))
 
 static const char msg_invalid_location[] = "Invalid location!";
 
+/**@brief Subscribed client, notified either with latitude and longitude or the full record. */
+typedef struct LocationSubscriber
+{
+    locationServerAcceptorFnPtr accept;
+    locationRecordAcceptorFnPtr accept_record;
+    bool filtered;                  /**< Fixes are filtered, otherwise every fix is notified. */
+    bool notified;                  /**< A fix has been notified since the filter was set. */
+    bool pending;                   /**< The newest fix is held back by min_interval_ms. */
+    uint8_t fix_count;              /**< Fixes since the last one considered, for decimation. */
+    LocationFilterType filter;
+    int64_t deadband_squared;       /**< Squared deadband_m in micro-degrees of latitude. */
+    LocationDataType reference;     /**< Last notified position. */
+    int32_t longitude_scale;        /**< Longitude scale of the reference position. */
+    uint32_t notify_time;           /**< Time of the last notification in ms. */
+    LocationPriorityType priority;
+} LocationSubscriberType;
+
+/**@brief Published fix, see @ref location_service_snapshot_get. */
+typedef struct LocationPublished
+{
+    LocationRecordType location;
+    uint32_t timestamp;             /**< app_timer counter value when the fix was published. */
+} LocationPublishedType;
+
+/**@brief Fix queued for dispatch. */
+typedef struct LocationDispatch
+{
+    LocationRecordType location;
+    uint32_t timestamp;             /**< app_timer counter value when the fix was received. */
+    uint8_t subscribers;            /**< Bit mask of the subscribers to notify. */
+} LocationDispatchType;
+
+APP_TIMER_DEF(pending_timer);
+
 // Private data
-static locationServerAcceptorFnPtr location_notification_handle[MAX_SUBSCRIBERS];
-static LocationDataType location;
+static LocationSubscriberType location_notification_handle[MAX_SUBSCRIBERS];
+static LocationRecordType location;     /**< Newest valid fix. */
+static uint32_t location_timestamp;     /**< app_timer counter value when the newest fix was received. */
+static LocationDispatchType dispatch_queue[LOCATION_DISPATCH_QUEUE_SIZE];
+static uint8_t dispatch_head;           /**< Oldest queued fix. */
+static uint8_t dispatch_count;
+static uint32_t dispatch_timestamp;     /**< Receive time of the fix being notified. */
+static bool dispatch_scheduled;         /**< The dispatch handler is queued in the scheduler. */
+static uint32_t fixes_coalesced;
+static uint8_t location_subscribers;    /**< Subscribers to notify of the current location, queued once per fix. */
+static volatile bool pending_timer_running;
+static LocationPublishedType published[2U];         /**< Double buffer, published_generation selects the current one. */
+static volatile uint32_t published_generation;
+static uint32_t parse_errors_reported;
+static uint64_t ticks;              /**< app_timer counter extended to 64 bit. */
+static uint32_t last_cnt;
 
 // Private method declarations
-static bool validate_location_data(const uint8_t *buffer, uint8_t received_bytes, LocationDataType *location);
-static void set_location_data(const uint8_t *buffer, uint8_t received_bytes, LocationDataType *location);
-static int8_t search_char(const uint8_t *buffer, uint8_t buffer_size, char c);
-static bool validate_coordinate(const uint8_t *buffer, uint8_t buffer_size, uint8_t decimal_pos, uint8_t max_degrees);void set_coordinate(const uint8_t *buffer, uint8_t buffer_size, CoordinateType *coordinate);
+static int8_t subscriber_add(const locationServerAcceptorFnPtr acceptorPtr,
+                             const locationRecordAcceptorFnPtr recordAcceptorPtr);
+static bool subscriber_filter(LocationSubscriberType *subscriber, uint32_t time_ms);
+static void subscriber_notify(const LocationSubscriberType *subscriber, const LocationRecordType *record);
+static void notify_subscribers(void);
+static void dispatch_enqueue(uint8_t subscribers);
+static void dispatch_handler(void *p_event_data, uint16_t event_size);
+static void snapshot_publish(void);
+static void location_set(const LocationRecordType *record, uint32_t timestamp);
+static void pending_flush(void);
+static void pending_timer_handler(void *p_context);
+static uint32_t time_get(void);
 
 /*
  * Public methods
@@ -27,122 +86,262 @@ static bool validate_coordinate(const uint8_t *buffer, uint8_t buffer_size, uint
 /**@brief Inits location service module */
 void location_service_init(void)
 {
-    for (uint8_t idx = 0U; idx < MAX_SUBSCRIBERS; ++idx)
-    {
-        location_notification_handle[idx] = NULL;
-    }
-    location_data_init(&location);
-}
-
-/**@brief Set location data to default values. */
-void location_data_init(LocationDataType *location_data)
-{
-    location_data->latitude.sign    = 1;
-    location_data->latitude.degrees = 0U;
-    location_data->latitude.decimal = 0UL;
-
-    location_data->longitude.sign    = 1;
-    location_data->longitude.degrees = 0U;
-    location_data->longitude.decimal = 0UL;
-}
+    ret_code_t err_code;
 
-/**@brief Converts location data to string */
-void location_data_serialize(const LocationDataType *location_data, uint8_t *buffer, uint8_t buffer_size)
-{
-    if (buffer_size >= (LATITUDE_MAX_DATA_SIZE + LONGITUDE_MAX_DATA_SIZE + 1U))
+    for (uint8_t idx = 0U; idx < MAX_SUBSCRIBERS; ++idx)
     {
-        buffer[LATITUDE_MAX_DATA_SIZE] = ',';
-
-        buffer[0U] = (location_data->latitude.sign > 0) ? '+' : '-';
-        buffer[3U] = '.';
-        uint8_t idx = 2U;
-        uint32_t tmp = location_data->latitude.degrees;
-        while (idx > 0U)
-        {
-            buffer[idx] = '0'+ (tmp % 10U);
-            tmp /= 10U;
-            --idx;
-        }
-        idx = DECIMAL_PRECISION;
-        tmp = location_data->latitude.decimal;
-        while (idx > 0U)
-        {
-            buffer[3U + idx] = '0' + (tmp % 10U);
-            tmp /= 10U;
-            --idx;
-        }
-
-        buffer[LATITUDE_MAX_DATA_SIZE + 1U] = (location_data->longitude.sign > 0) ? '+' : '-';
-        buffer[LATITUDE_MAX_DATA_SIZE + 5U] = '.';
-        idx = 3U;
-        tmp = location_data->longitude.degrees;
-        while (idx > 0U)
-        {
-            buffer[LATITUDE_MAX_DATA_SIZE + 1U + idx] = '0' + (tmp % 10U);
-            tmp /= 10U;
-            --idx;
-        }
-        idx = DECIMAL_PRECISION;
-        tmp = location_data->longitude.decimal;
-        while (idx > 0U)
-        {
-            buffer[LATITUDE_MAX_DATA_SIZE + 5U + idx] = '0' + (tmp % 10U);
-            tmp /= 10U;
-            --idx;
-        }
+        location_notification_handle[idx].accept = NULL;
+        location_notification_handle[idx].accept_record = NULL;
+        location_notification_handle[idx].filtered = false;
     }
+    location_record_init(&location);
+    dispatch_head = 0U;
+    dispatch_count = 0U;
+    dispatch_scheduled = false;
+    fixes_coalesced = 0UL;
+    location_subscribers = 0U;
+    location_timestamp = 0UL;
+    dispatch_timestamp = 0UL;
+    parse_errors_reported = 0UL;
+    published_generation = 0UL;
+    ticks = 0U;
+    last_cnt = app_timer_cnt_get();
+    pending_timer_running = false;
+
+    err_code = app_timer_create(&pending_timer, APP_TIMER_MODE_SINGLE_SHOT, pending_timer_handler);
+    APP_ERROR_CHECK(err_code);
 }
 
-/**@brief Updates location data and notifies subscribed clients.
+/**@brief Updates location data and queues notifications of subscribed clients.
  * 
- * @details Checks for new data received on UART, validates and sets new location data and notifies
- *          subscribed clients.
+ * @details Parses the newest line received on UART since the last call and queues a
+ *          notification of subscribed clients if it is valid. Older lines are skipped by the GNSS
+ *          handler and counted as dropped. Lines are parsed in place in the receive storage of the
+ *          GNSS handler. If a protocol backend is used
+ *          instead, lines or messages are parsed while receiving and the latest location decoded
+ *          by the GNSS handler is forwarded. Fixes held back from rate limited subscribers are
+ *          queued once their minimum interval has passed.
+ *
+ *          Clients are notified from app_sched_execute, so ingest never waits for a slow
+ *          client. Up to LOCATION_DISPATCH_QUEUE_SIZE fixes are queued, if clients fall further
+ *          behind the newest queued fix is replaced.
 */
 void location_service_update(void)
 {
-    /* size of buffer equal to latitude + longitude data + 3 bytes for comma and UART CR LF */
-    static uint8_t buffer[LATITUDE_MAX_DATA_SIZE + LONGITUDE_MAX_DATA_SIZE + 3U];
-    static uint8_t bytes_received = 0U;
+    GnssLineType line;
+    LocationRecordType record;
+    uint32_t timestamp;
 
-    if (gnss_handler_receive(&bytes_received, buffer, sizeof(buffer)) && (bytes_received > 0U))
+    while (gnss_handler_line_acquire(&line))
     {
-        if (validate_location_data(buffer, bytes_received, &location))
+        // Lines carry latitude and longitude only
+        location_record_init(&record);
+        if (LOCATION_PARSE_SUCCESS == location_parser_parse(line.p_data, line.length, &record.position, NULL))
         {
-            set_location_data(buffer, bytes_received, &location);
-            for (uint8_t idx = 0U; idx < MAX_SUBSCRIBERS; ++idx)
-            {
-                if (NULL != location_notification_handle[idx])
-                {
-                    location_notification_handle[idx](&location);
-                }
-            }
+            location_set(&record, line.timestamp);
         }
         else
         {
             gnss_handler_transmit((uint8_t *)msg_invalid_location, sizeof(msg_invalid_location));
         }
 
-        bytes_received = 0U;
+        gnss_handler_line_release();
     }
+
+    if (gnss_handler_location_get(&record, &timestamp))
+    {
+        location_set(&record, timestamp);
+    }
+
+    pending_flush();
+    dispatch_enqueue(location_subscribers);
+    location_subscribers = 0U;
+
+#if (GNSS_PROTOCOL == GNSS_PROTOCOL_ASCII)
+    // Lines have been rejected while receiving, report once per update.
+    uint32_t parse_errors = gnss_handler_parse_errors();
+    if (parse_errors != parse_errors_reported)
+    {
+        parse_errors_reported = parse_errors;
+        gnss_handler_transmit((uint8_t *)msg_invalid_location, sizeof(msg_invalid_location));
+    }
+#endif
 }
 
 /**@brief Function to subscribe to location server.
  * 
  * @details Callback function can be registered with location server to get notified about new data.
+ *          Callbacks are called from app_sched_execute in the main loop.
  * 
  * @param[in]   acceptorPtr     Function pointer for registering with location server.
  * 
  * @returns handle >= 0 if subscription was successfull, -1 otherwise.
 */
 int8_t location_service_subscribe(const locationServerAcceptorFnPtr acceptorPtr)
+{
+    return subscriber_add(acceptorPtr, NULL);
+}
+
+/**@brief Function to subscribe to the full location record.
+ * 
+ * @details Like @ref location_service_subscribe, but the callback receives altitude, speed, course,
+ *          DOP, satellites, fix type and UTC time as far as provided by the receiver protocol.
+ *          Clients only interested in latitude and longitude should use
+ *          @ref location_service_subscribe.
+ * 
+ * @param[in]   acceptorPtr     Function pointer for registering with location server.
+ * 
+ * @returns handle >= 0 if subscription was successfull, -1 otherwise.
+*/
+int8_t location_service_subscribe_record(const locationRecordAcceptorFnPtr acceptorPtr)
+{
+    return subscriber_add(NULL, acceptorPtr);
+}
+
+/**@brief Sets the notification filter of a subscriber.
+ * 
+ * @details A filtered subscriber is only notified if the position has left the deadband around
+ *          the last notified position, or if no fix has been notified for max_silence_ms. The
+ *          deadband is either a circle of deadband_m or, if deadband_m is 0, a rectangle of
+ *          deadband_latitude and deadband_longitude. With a deadband of 0, only unchanged
+ *          positions are suppressed. Other fields of the location record do not affect the
+ *          filter. The first fix after setting the filter is always notified.
+ *
+ *          Before the deadband, fixes are rate limited. Only every decimation-th fix is
+ *          considered, and fixes arriving within min_interval_ms of the last notification are
+ *          held back. The newest held back fix is considered once the interval has passed, so a
+ *          throttled subscriber does not miss the end of a movement.
+ * 
+ * @param[in]   handle      Handle returned by the subscribe function.
+ * @param[in]   filter      Filter, NULL to notify every fix.
+ * 
+ * @returns true if the filter was set, false if the handle is invalid.
+*/
+bool location_service_filter_set(int8_t handle, const LocationFilterType *filter)
+{
+    LocationSubscriberType *subscriber;
+    int64_t deadband;
+
+    if ((handle < 0) || (handle >= (int8_t)MAX_SUBSCRIBERS))
+    {
+        return false;
+    }
+
+    subscriber = &location_notification_handle[handle];
+    subscriber->filtered = (NULL != filter);
+    subscriber->notified = false;
+    subscriber->pending = false;
+    subscriber->fix_count = 0U;
+    if (NULL != filter)
+    {
+        subscriber->filter = *filter;
+        deadband = ((int64_t)filter->deadband_m * MICRO_DEGREES_PER_DEGREE) / METERS_PER_DEGREE;
+        subscriber->deadband_squared = deadband * deadband;
+    }
+
+    return true;
+}
+
+/**@brief Sets the dispatch priority of a subscriber.
+ * 
+ * @details Subscribers are called from the main loop by the scheduler. Subscribers of high
+ *          priority are notified of all queued fixes before subscribers of lower priority are
+ *          notified of any, so they do not wait for slower subscribers of lower priority, also
+ *          not for those of older fixes. Subscribers of the same priority are notified in the
+ *          order of subscription, and every subscriber gets the queued fixes in order.
+ * 
+ * @param[in]   handle      Handle returned by the subscribe function.
+ * @param[in]   priority    Dispatch priority.
+ * 
+ * @returns true if the priority was set, false if the handle or priority is invalid.
+*/
+bool location_service_priority_set(int8_t handle, LocationPriorityType priority)
+{
+    if ((handle < 0) || (handle >= (int8_t)MAX_SUBSCRIBERS) || (priority >= LOCATION_PRIORITY_COUNT))
+    {
+        return false;
+    }
+
+    location_notification_handle[handle].priority = priority;
+
+    return true;
+}
+
+/**@brief Returns the number of fixes replaced in the dispatch queue before being notified. */
+uint32_t location_service_fixes_coalesced(void)
+{
+    return fixes_coalesced;
+}
+
+/**@brief Returns the app_timer counter value at which the fix being notified was received.
+ * 
+ * @details Only valid within a subscriber function. The time is taken when the line or the
+ *          receiver message was completed, so it includes the delay of parsing, of the dispatch
+ *          queue and of a minimum interval holding the fix back.
+*/
+uint32_t location_service_fix_timestamp_get(void)
+{
+    return dispatch_timestamp;
+}
+
+/**@brief Gets the latest fix and its age from any context, including interrupt handlers.
+ * 
+ * @details Every valid fix is published by @ref location_service_update into one of two buffers,
+ *          the other one stays untouched until the generation counter has moved on. A reader
+ *          preempting the update thus still copies a consistent fix, so interrupt handlers never
+ *          retry and never block the main loop. The copy is repeated only if the update itself
+ *          published a fix meanwhile, which cannot happen for readers of higher priority.
+ *          The fix is published regardless of subscriber filters.
+ * 
+ * @param[out]  snapshot    Latest fix, its generation and age.
+ * 
+ * @returns true if a fix has been published, false otherwise.
+*/
+bool location_service_snapshot_get(LocationSnapshotType *snapshot)
+{
+    uint32_t generation;
+    uint32_t timestamp;
+
+    do
+    {
+        generation = published_generation;
+        if (0UL == generation)
+        {
+            return false;
+        }
+        __DMB();
+        snapshot->location = published[generation & 1U].location;
+        timestamp = published[generation & 1U].timestamp;
+        __DMB();
+    } while (generation != published_generation);
+
+    snapshot->generation = generation;
+    snapshot->age_ms = (uint32_t)(((uint64_t)app_timer_cnt_diff_compute(app_timer_cnt_get(), timestamp) * 1000U) /
+                                  APP_TIMER_TICK_FREQ);
+
+    return true;
+}
+
+
+/*
+ * Private methods
+ */
+
+/**@brief Registers a client in the first free subscriber slot. */
+static int8_t subscriber_add(const locationServerAcceptorFnPtr acceptorPtr,
+                             const locationRecordAcceptorFnPtr recordAcceptorPtr)
 {
     int8_t handle = -1;
 
     for (uint8_t idx = 0U; idx < MAX_SUBSCRIBERS; ++idx)
     {
-        if (NULL == location_notification_handle[idx])
+        if ((NULL == location_notification_handle[idx].accept) &&
+            (NULL == location_notification_handle[idx].accept_record))
         {
-            location_notification_handle[idx] = acceptorPtr;
+            location_notification_handle[idx].accept = acceptorPtr;
+            location_notification_handle[idx].accept_record = recordAcceptorPtr;
+            location_notification_handle[idx].filtered = false;
+            location_notification_handle[idx].priority = LOCATION_PRIORITY_NORMAL;
             handle = idx;
             break;
         }
@@ -151,189 +350,321 @@ int8_t location_service_subscribe(const locationServerAcceptorFnPtr acceptorPtr)
     return handle;
 }
 
-
-/*
- * Private methods
+/**@brief Checks whether a filtered subscriber is notified about the current location.
+ *
+ * @details Updates the reference position and time if so.
  */
-
-/**@brief Validates location data. */
-static bool validate_location_data(const uint8_t * buffer, uint8_t received_bytes, LocationDataType * location)
+static bool subscriber_filter(LocationSubscriberType *subscriber, uint32_t time_ms)
 {
-    bool is_valid_latitude = true;
-    bool is_valid_longitude = true;
-    int8_t comma_pos = 0U;
-    int8_t decimal_pos = 0U;
+    const LocationFilterType *filter = &subscriber->filter;
+    bool notify = !subscriber->notified;
 
-    // Check input params
-    if ((NULL == buffer ) || (NULL == location) || (0U == received_bytes))
+    if (!notify && (0U != filter->max_silence_ms))
     {
-        return false;
+        notify = ((time_ms - subscriber->notify_time) >= filter->max_silence_ms);
     }
 
-    // Search comma
-    comma_pos = search_char(buffer, received_bytes, ',');
+    if (!notify && (0U != filter->deadband_m))
+    {
+        notify = (location_distance_squared(&subscriber->reference, &location.position,
+                                            subscriber->longitude_scale) > subscriber->deadband_squared);
+    }
+    else if (!notify)
+    {
+        int32_t dlat;
+        int32_t dlon;
 
-    if ((comma_pos > 0) && (comma_pos < received_bytes))
+        location_delta(&subscriber->reference, &location.position, &dlat, &dlon);
+        notify = ((uint32_t)abs(dlat) > filter->deadband_latitude) ||
+                 ((uint32_t)abs(dlon) > filter->deadband_longitude);
+    }
+
+    if (notify)
     {
-        decimal_pos = search_char(buffer, comma_pos, '.');
-        if ((decimal_pos >= 0) && (decimal_pos < 4) &&
-            ((comma_pos - decimal_pos - 1) == DECIMAL_PRECISION))
-        {
-            is_valid_latitude = validate_coordinate(buffer, comma_pos, decimal_pos, MAX_ABS_LATITUDE);
-        }
-        else
+        if (0U != filter->deadband_m)
         {
-            is_valid_latitude = false;
+            subscriber->longitude_scale = location_longitude_scale(location.position.latitude);
         }
+        subscriber->reference = location.position;
+        subscriber->notify_time = time_ms;
+        subscriber->notified = true;
+    }
+
+    return notify;
+}
+
+/**@brief Calls the acceptor function of a subscriber. */
+static void subscriber_notify(const LocationSubscriberType *subscriber, const LocationRecordType *record)
+{
+    if (NULL != subscriber->accept)
+    {
+        subscriber->accept(&record->position);
+    }
+    else if (NULL != subscriber->accept_record)
+    {
+        subscriber->accept_record(record);
+    }
+}
+
+/**@brief Makes a new fix the current location.
+ *
+ * @details The previous fix is queued for its subscribers first, so every fix is queued once
+ *          with the subscribers collected from both the new fix and the held back fixes.
+ */
+static void location_set(const LocationRecordType *record, uint32_t timestamp)
+{
+    dispatch_enqueue(location_subscribers);
+
+    location = *record;
+    location_timestamp = timestamp;
+    snapshot_publish();
+    location_subscribers = 0U;
+    notify_subscribers();
+}
 
-        if (is_valid_latitude)
+/**@brief Selects the subscribers of the current location, subject to their filters. */
+static void notify_subscribers(void)
+{
+    uint32_t time_ms = time_get();
+
+    for (uint8_t idx = 0U; idx < MAX_SUBSCRIBERS; ++idx)
+    {
+        LocationSubscriberType *subscriber = &location_notification_handle[idx];
+
+        if (subscriber->filtered)
         {
-            uint8_t longitude_received_bytes = received_bytes - comma_pos - 1;
-            const uint8_t *longitude_buffer = &buffer[comma_pos + 1U];
+            const LocationFilterType *filter = &subscriber->filter;
 
-            decimal_pos = search_char(longitude_buffer, longitude_received_bytes, '.');
-            if ((decimal_pos >= 0) && (decimal_pos < 5) &&
-                ((longitude_received_bytes - decimal_pos - 1) == DECIMAL_PRECISION))
+            if (++subscriber->fix_count < filter->decimation)
             {
-                is_valid_longitude = validate_coordinate(longitude_buffer, longitude_received_bytes, decimal_pos, MAX_ABS_LONGITUDE);
+                continue;
             }
-            else
+
+            if (subscriber->notified && ((time_ms - subscriber->notify_time) < filter->min_interval_ms))
             {
-                is_valid_longitude = false;
+                // Counts as considered, decimation restarts with the next fix
+                subscriber->fix_count = 0U;
+                subscriber->pending = true;
+                continue;
+            }
+
+            subscriber->fix_count = 0U;
+            subscriber->pending = false;
+            if (!subscriber_filter(subscriber, time_ms))
+            {
+                continue;
             }
         }
+
+        if ((NULL != subscriber->accept) || (NULL != subscriber->accept_record))
+        {
+            location_subscribers |= (1U << idx);
+        }
     }
-    else
-    {
-        is_valid_latitude = false;
-        is_valid_longitude = false;
-    }
-    
-    return (is_valid_latitude && is_valid_longitude);
 }
 
-/**@brief Sets location data.
- * 
- * @attention   This function does not validate data in input buffer!
-*/
-static void set_location_data(const uint8_t *buffer, uint8_t received_bytes, LocationDataType *location)
+/**@brief Considers the held back fix of rate limited subscribers whose interval has passed.
+ *
+ * @details If fixes are still held back, a single shot timer wakes up the main loop when the
+ *          next interval has passed, in case no further fix arrives until then.
+ */
+static void pending_flush(void)
 {
-    uint8_t comma_pos = 0U;
+    uint32_t time_ms = time_get();
+    uint32_t wait_ms = UINT32_MAX;
 
-    if ((NULL != buffer) && (NULL != location) && (received_bytes > 0U))
+    for (uint8_t idx = 0U; idx < MAX_SUBSCRIBERS; ++idx)
     {
-        comma_pos   = search_char(buffer, received_bytes, ',');
+        LocationSubscriberType *subscriber = &location_notification_handle[idx];
+        uint32_t elapsed_ms = time_ms - subscriber->notify_time;
+
+        if (!subscriber->pending)
+        {
+            continue;
+        }
+
+        if (elapsed_ms < subscriber->filter.min_interval_ms)
+        {
+            wait_ms = MIN(wait_ms, subscriber->filter.min_interval_ms - elapsed_ms);
+            continue;
+        }
 
-        set_coordinate(buffer, comma_pos, &location->latitude);
+        subscriber->fix_count = 0U;
+        subscriber->pending = false;
+        if (subscriber_filter(subscriber, time_ms))
+        {
+            location_subscribers |= (1U << idx);
+        }
+    }
 
-        const uint8_t *longitude_buffer = &buffer[comma_pos + 1U];
-        uint8_t longitude_received_bytes = received_bytes - comma_pos - 1U;
-        set_coordinate(longitude_buffer, longitude_received_bytes, &location->longitude);
+    if ((UINT32_MAX != wait_ms) && !pending_timer_running)
+    {
+        ret_code_t err_code;
+
+        pending_timer_running = true;
+        err_code = app_timer_start(pending_timer, MAX(APP_TIMER_TICKS(wait_ms), APP_TIMER_MIN_TIMEOUT_TICKS), NULL);
+        APP_ERROR_CHECK(err_code);
     }
 }
 
-void set_coordinate(const uint8_t *buffer, uint8_t buffer_size, CoordinateType *coordinate)
+/**@brief Publishes the current location for @ref location_service_snapshot_get.
+ *
+ * @details Writes the buffer not selected by the current generation, the barrier makes the fix
+ *          visible before the new generation selects it.
+ */
+static void snapshot_publish(void)
 {
-    uint8_t idx = 0U;
-    uint8_t decimal_pos = search_char(buffer, buffer_size, '.');
+    uint32_t generation = published_generation + 1UL;
 
-    if ('+' == buffer[idx])
+    // Generation 0 marks no fix, skipping it on wrap around keeps the buffers alternating
+    if (0UL == generation)
     {
-        coordinate->sign = 1;
-        ++idx;
+        generation = 2UL;
     }
-    else if ('-' == buffer[idx])
+
+    published[generation & 1U].location = location;
+    published[generation & 1U].timestamp = app_timer_cnt_get();
+    __DMB();
+    published_generation = generation;
+}
+
+/**@brief Queues the current location for dispatch to the given subscribers.
+ *
+ * @details If the queue is full, the newest queued fix is replaced, so clients falling behind
+ *          skip intermediate fixes but always get the latest one.
+ *
+ * @param[in]   subscribers     Bit mask of the subscribers to notify.
+ */
+static void dispatch_enqueue(uint8_t subscribers)
+{
+    LocationDispatchType *dispatch;
+
+    if (0U == subscribers)
     {
-        coordinate->sign = -1;
-        ++idx;
+        return;
     }
-    else
+
+    if (LOCATION_DISPATCH_QUEUE_SIZE == dispatch_count)
     {
-        coordinate->sign = 1;
+        dispatch = &dispatch_queue[(dispatch_head + dispatch_count - 1U) % LOCATION_DISPATCH_QUEUE_SIZE];
+        dispatch->subscribers |= subscribers;
+        fixes_coalesced++;
     }
-
-    coordinate->degrees = 0U;
-    for (; idx < decimal_pos; ++idx)
+    else
     {
-        coordinate->degrees *= 10U;
-        coordinate->degrees += (buffer[idx] - '0');
+        dispatch = &dispatch_queue[(dispatch_head + dispatch_count) % LOCATION_DISPATCH_QUEUE_SIZE];
+        dispatch->subscribers = subscribers;
+        dispatch_count++;
     }
+    dispatch->location = location;
+    dispatch->timestamp = location_timestamp;
 
-    coordinate->decimal = 0UL;
-    for (idx = decimal_pos + 1U; idx < buffer_size; ++idx)
+    if (!dispatch_scheduled)
     {
-        coordinate->decimal *= 10U;
-        coordinate->decimal += (buffer[idx] - '0');
+        ret_code_t err_code = app_sched_event_put(NULL, 0U, dispatch_handler);
+        APP_ERROR_CHECK(err_code);
+        dispatch_scheduled = true;
     }
 }
 
-static int8_t search_char(const uint8_t * buffer, uint8_t buffer_size, char c)
+/**@brief Notifies the subscribers of the highest waiting priority of all queued fixes.
+ *
+ * @details Each scheduler event serves one priority across all queued fixes, oldest fix first,
+ *          and the next event the next lower priority still waiting. A subscriber of high
+ *          priority thus gets every queued fix before subscribers of lower priority get older
+ *          ones, and other scheduler events are not held up by a backlog of slow subscribers.
+ */
+static void dispatch_handler(void *p_event_data, uint16_t event_size)
 {
-    int8_t pos = -1;
+    uint8_t waiting = 0U;
+    uint8_t served = 0U;
+    uint8_t priority = LOCATION_PRIORITY_COUNT;
+    uint8_t count = 0U;
 
-    for (uint8_t idx = 0U; idx < buffer_size; ++idx)
-    {
-        if (c == buffer[idx])
-        {
-            pos = idx;
-            break;
-        }
-    }
-
-    return pos;
-}
+    UNUSED_PARAMETER(p_event_data);
+    UNUSED_PARAMETER(event_size);
 
-static bool validate_coordinate(const uint8_t *buffer, uint8_t buffer_size, uint8_t decimal_pos, uint8_t max_degrees)
-{
-    bool is_valid = true;
-    uint8_t idx = 0U;
-    uint8_t degrees = 0U;
+    dispatch_scheduled = false;
 
-    // Check leading sign
-    if (('+' == buffer[idx]) || ('-' == buffer[idx]))
+    for (uint8_t pos = 0U; pos < dispatch_count; ++pos)
     {
-        ++idx;
+        waiting |= dispatch_queue[(dispatch_head + pos) % LOCATION_DISPATCH_QUEUE_SIZE].subscribers;
     }
 
-    // Check degrees
-    for (; idx < decimal_pos; ++idx)
+    for (uint8_t idx = 0U; idx < MAX_SUBSCRIBERS; ++idx)
     {
-        char c = buffer[idx];
-        if (isdigit(c) == 0)
+        if ((waiting & (1U << idx)) && (location_notification_handle[idx].priority < priority))
         {
-            is_valid = false;
-            break;
+            priority = location_notification_handle[idx].priority;
         }
-        else
+    }
+
+    for (uint8_t idx = 0U; idx < MAX_SUBSCRIBERS; ++idx)
+    {
+        if ((waiting & (1U << idx)) && (location_notification_handle[idx].priority == priority))
         {
-            degrees *= 10;
-            degrees += (c - '0');
+            served |= (1U << idx);
         }
     }
 
-    // Check decimal degrees
-    if (is_valid)
+    for (uint8_t pos = 0U; pos < dispatch_count; ++pos)
     {
-        for (idx = decimal_pos + 1U; idx < buffer_size; ++idx)
+        LocationDispatchType *dispatch = &dispatch_queue[(dispatch_head + pos) % LOCATION_DISPATCH_QUEUE_SIZE];
+
+        dispatch_timestamp = dispatch->timestamp;
+        for (uint8_t idx = 0U; idx < MAX_SUBSCRIBERS; ++idx)
         {
-            if (degrees < max_degrees)
+            if (dispatch->subscribers & served & (1U << idx))
             {
-                if (isdigit(buffer[idx]) == 0)
-                {
-                    is_valid = false;
-                    break;
-                }
+                subscriber_notify(&location_notification_handle[idx], &dispatch->location);
             }
-            else
+        }
+        dispatch->subscribers &= (uint8_t)~served;
+    }
+
+    // Drop fixes all subscribers have been notified of, keeping the order of the others
+    for (uint8_t pos = 0U; pos < dispatch_count; ++pos)
+    {
+        const LocationDispatchType *dispatch = &dispatch_queue[(dispatch_head + pos) % LOCATION_DISPATCH_QUEUE_SIZE];
+
+        if (0U != dispatch->subscribers)
+        {
+            if (count != pos)
             {
-                if ('0' != buffer[idx])
-                {
-                    is_valid = false;
-                    break;
-                }
+                dispatch_queue[(dispatch_head + count) % LOCATION_DISPATCH_QUEUE_SIZE] = *dispatch;
             }
+            count++;
         }
     }
+    dispatch_count = count;
+
+    if ((0U != dispatch_count) && !dispatch_scheduled)
+    {
+        ret_code_t err_code = app_sched_event_put(NULL, 0U, dispatch_handler);
+        APP_ERROR_CHECK(err_code);
+        dispatch_scheduled = true;
+    }
+}
+
+/**@brief Wakes up the main loop to notify held back fixes. */
+static void pending_timer_handler(void *p_context)
+{
+    UNUSED_PARAMETER(p_context);
+
+    pending_timer_running = false;
+}
+
+/**@brief Returns the current time in ms.
+ *
+ * @details The 24 bit app_timer counter is extended to 64 bit, so the time stays monotonic as
+ *          long as fixes arrive at least once per counter period.
+ */
+static uint32_t time_get(void)
+{
+    uint32_t cnt = app_timer_cnt_get();
+
+    ticks += app_timer_cnt_diff_compute(cnt, last_cnt);
+    last_cnt = cnt;
 
-    return is_valid;
+    return (uint32_t)((ticks * 1000U) / APP_TIMER_TICK_FREQ);
 }
\ No newline at end of file
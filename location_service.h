@@ -3,30 +3,51 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "location_data.h"
 
-#define LATITUDE_MAX_DATA_SIZE      10U     /**< Maximum length of received latitude data. */
-#define LONGITUDE_MAX_DATA_SIZE     11U     /**< Maximum length of received longitude data. */
+typedef void (*locationServerAcceptorFnPtr)(const LocationDataType* const);
+typedef void (*locationRecordAcceptorFnPtr)(const LocationRecordType* const);
 
-typedef struct Coordinate
-{
-    int8_t sign;
-    uint8_t degrees;
-    uint32_t decimal;
-} CoordinateType;
+#ifndef LOCATION_DISPATCH_QUEUE_SIZE
+#define LOCATION_DISPATCH_QUEUE_SIZE    4U  /**< Fixes queued for dispatch, further fixes replace the newest one. */
+#endif
 
-typedef struct LocationData
+/**@brief Latest fix with its age, see @ref location_service_snapshot_get. */
+typedef struct LocationSnapshot
 {
-    CoordinateType latitude;
-    CoordinateType longitude;
-} LocationDataType;
+    LocationRecordType location;
+    uint32_t generation;            /**< Number of fixes published since init. */
+    uint32_t age_ms;                /**< Time since the fix was published, valid within the app_timer counter period. */
+} LocationSnapshotType;
 
-typedef void (*locationServerAcceptorFnPtr)(const LocationDataType* const);
+/**@brief Dispatch priority of a subscriber, see @ref location_service_priority_set. */
+typedef enum LocationPriority
+{
+    LOCATION_PRIORITY_HIGH,         /**< Notified first. */
+    LOCATION_PRIORITY_NORMAL,       /**< Default. */
+    LOCATION_PRIORITY_LOW,          /**< Notified last, e.g. logging and statistics. */
+    LOCATION_PRIORITY_COUNT
+} LocationPriorityType;
+
+/**@brief Notification filter of a subscriber, see @ref location_service_filter_set. */
+typedef struct LocationFilter
+{
+    uint32_t deadband_m;            /**< Minimum distance from the last notified position in m, 0 to use the axes. */
+    uint32_t deadband_latitude;     /**< Minimum latitude change in micro-degrees, used if deadband_m is 0. */
+    uint32_t deadband_longitude;    /**< Minimum longitude change in micro-degrees, used if deadband_m is 0. */
+    uint32_t max_silence_ms;        /**< Time after which the next fix is notified anyway, 0 to disable. */
+    uint32_t min_interval_ms;       /**< Minimum time between notifications, 0 to disable. */
+    uint8_t decimation;             /**< Only every n-th fix is considered, 0 or 1 for every fix. */
+} LocationFilterType;
 
 void location_service_init(void);
 void location_service_update(void);
 int8_t location_service_subscribe(const locationServerAcceptorFnPtr acceptorPtr);
-
-void location_data_init(LocationDataType* location_data);
-void location_data_serialize(const LocationDataType* location_data, uint8_t *buffer, uint8_t buffer_size);
+int8_t location_service_subscribe_record(const locationRecordAcceptorFnPtr acceptorPtr);
+bool location_service_filter_set(int8_t handle, const LocationFilterType *filter);
+bool location_service_priority_set(int8_t handle, LocationPriorityType priority);
+uint32_t location_service_fixes_coalesced(void);
+uint32_t location_service_fix_timestamp_get(void);
+bool location_service_snapshot_get(LocationSnapshotType *snapshot);
 
 #endif // LOCATION_SERVICE_H__
\ No newline at end of file
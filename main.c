@@ -52,10 +52,22 @@
 #include "nordic_common.h"
 #include "bsp.h"
 #include "app_timer.h"
+#include "app_scheduler.h"
 #include "nrf_pwr_mgmt.h"
 #include "gnss_handler.h"
 #include "location_service.h"
 #include "beacon_manager.h"
+#include "beacon_config.h"
+#if BEACON_CONNECTABLE
+#include "navigation_service.h"
+#include "track_service.h"
+#endif
+#ifdef BENCHMARK
+#include "benchmark.h"
+#endif
+
+#define SCHED_MAX_EVENT_DATA_SIZE       0U      /**< Scheduler events carry no data, handlers use their module state. */
+#define SCHED_QUEUE_SIZE                4U      /**< Maximum number of events in the scheduler queue. */
 
 
 /**@brief Function for initializing LEDs. */
@@ -74,6 +86,13 @@ static void timers_init(void)
 }
 
 
+/**@brief Function for initializing the event scheduler. */
+static void scheduler_init(void)
+{
+    APP_SCHED_INIT(SCHED_MAX_EVENT_DATA_SIZE, SCHED_QUEUE_SIZE);
+}
+
+
 /**@brief Function for initializing power management.
  */
 static void power_management_init(void)
@@ -99,11 +118,19 @@ int main(void)
 {
     // Initialize.
     timers_init();
+    scheduler_init();
     leds_init();
     power_management_init();
     gnss_handler_init();
     location_service_init();
     beacon_manager_init();
+#ifdef BENCHMARK
+    benchmark_run();
+#endif
+#if BEACON_CONNECTABLE
+    navigation_service_init();
+    track_service_init();
+#endif
 
     // Start execution.
     beacon_advertising_start();
@@ -112,6 +139,8 @@ int main(void)
     for (;;)
     {
         location_service_update();
+        app_sched_execute();
+        beacon_manager_update();
         idle_state_handle();
     }
 }
@@ -0,0 +1,229 @@
+#include <string.h>
+#include "nordic_common.h"
+#include "app_error.h"
+#include "nrf_sdh_ble.h"
+#include "ble_srv_common.h"
+#include "beacon_config.h"
+#include "navigation_service.h"
+#include "location_service.h"
+
+#define LN_FEATURE_SPEED_SUPPORTED          0x00000001UL    /**< LN Feature bit, instantaneous speed supported. */
+#define LN_FEATURE_LOCATION_SUPPORTED       0x00000004UL    /**< LN Feature bit, location supported. */
+#define LN_FEATURE_ELEVATION_SUPPORTED      0x00000008UL    /**< LN Feature bit, elevation supported. */
+#define LN_FEATURE_HEADING_SUPPORTED        0x00000010UL    /**< LN Feature bit, heading supported. */
+
+#define LOC_SPEED_FLAG_SPEED_PRESENT        0x0001U         /**< Location and Speed flag, instantaneous speed present. */
+#define LOC_SPEED_FLAG_LOCATION_PRESENT     0x0004U         /**< Location and Speed flag, location present. */
+#define LOC_SPEED_FLAG_ELEVATION_PRESENT    0x0008U         /**< Location and Speed flag, elevation present. */
+#define LOC_SPEED_FLAG_HEADING_PRESENT      0x0010U         /**< Location and Speed flag, heading present. */
+#define LOC_SPEED_FLAG_POSITION_OK          (1U << 7)       /**< Location and Speed position status, position ok. */
+
+#define LOC_SPEED_MAX_LENGTH                17U             /**< Flags, speed, latitude, longitude, elevation and heading. */
+#define LN_COORDINATE_SCALE                 10L             /**< LNS coordinates are given in 1e-7 deg. */
+#define LN_ELEVATION_DIVISOR                10L             /**< LNS elevation is given in cm. */
+
+// Private data
+static int8_t ls_handle;                                    /**< Location service handle. */
+static uint16_t service_handle;
+static ble_gatts_char_handles_t feature_handles;
+static ble_gatts_char_handles_t loc_speed_handles;
+static uint16_t conn_handle = BLE_CONN_HANDLE_INVALID;
+static bool notifications_enabled;
+static uint32_t notifications_dropped;
+
+// Private method declarations
+static void navigation_service_accept(const LocationRecordType *location_record);
+static void navigation_service_on_ble_evt(ble_evt_t const *p_ble_evt, void *p_context);
+static void characteristics_add(void);
+static uint8_t loc_speed_encode(const LocationRecordType *location_record, uint8_t *buffer);
+
+NRF_SDH_BLE_OBSERVER(navigation_service_observer, APP_BLE_OBSERVER_PRIO, navigation_service_on_ble_evt, NULL);
+
+/*
+ * Public methods
+ */
+
+/**@brief Adds the Location and Navigation Service to the GATT server.
+ *
+ * @details The service contains the mandatory LN Feature and Location and Speed characteristics,
+ *          the latter notifies every fix received from the location service to a connected
+ *          central which enabled notifications.
+ */
+void navigation_service_init(void)
+{
+    uint32_t err_code;
+    ble_uuid_t ble_uuid;
+
+    BLE_UUID_BLE_ASSIGN(ble_uuid, BLE_UUID_LOCATION_NAVIGATION_SERVICE);
+
+    err_code = sd_ble_gatts_service_add(BLE_GATTS_SRVC_TYPE_PRIMARY, &ble_uuid, &service_handle);
+    APP_ERROR_CHECK(err_code);
+
+    characteristics_add();
+
+    conn_handle = BLE_CONN_HANDLE_INVALID;
+    notifications_enabled = false;
+    notifications_dropped = 0UL;
+
+    ls_handle = location_service_subscribe_record(&navigation_service_accept);
+    if (ls_handle < 0)
+    {
+        // All subscriber slots taken, see MAX_SUBSCRIBERS
+        APP_ERROR_CHECK(NRF_ERROR_NO_MEM);
+    }
+}
+
+/**@brief Returns the number of fixes not notified because the notification queue was full. */
+uint32_t navigation_service_notifications_dropped(void)
+{
+    return notifications_dropped;
+}
+
+/*
+ * Private methods
+ */
+
+/**@brief Subscription function for accepting new location records
+ *
+ * @details Notifies the location to the connected central. A full notification queue drops the
+ *          fix, the next one follows within the fix interval.
+ *
+ * @param[in]   location_record Pointer to location record.
+ */
+static void navigation_service_accept(const LocationRecordType *location_record)
+{
+    uint32_t err_code;
+    uint8_t buffer[LOC_SPEED_MAX_LENGTH];
+    uint16_t length;
+    ble_gatts_hvx_params_t hvx_params;
+
+    if ((BLE_CONN_HANDLE_INVALID == conn_handle) || !notifications_enabled)
+    {
+        return;
+    }
+
+    length = loc_speed_encode(location_record, buffer);
+
+    memset(&hvx_params, 0, sizeof(hvx_params));
+    hvx_params.handle = loc_speed_handles.value_handle;
+    hvx_params.type = BLE_GATT_HVX_NOTIFICATION;
+    hvx_params.p_len = &length;
+    hvx_params.p_data = buffer;
+
+    err_code = sd_ble_gatts_hvx(conn_handle, &hvx_params);
+    if (NRF_ERROR_RESOURCES == err_code)
+    {
+        notifications_dropped++;
+    }
+    else if ((NRF_SUCCESS != err_code) &&
+             (NRF_ERROR_INVALID_STATE != err_code) &&
+             (BLE_ERROR_INVALID_CONN_HANDLE != err_code) &&
+             (BLE_ERROR_GATTS_SYS_ATTR_MISSING != err_code))
+    {
+        APP_ERROR_HANDLER(err_code);
+    }
+}
+
+/**@brief Tracks the connection and the notification state of the Location and Speed
+ *        characteristic.
+ */
+static void navigation_service_on_ble_evt(ble_evt_t const *p_ble_evt, void *p_context)
+{
+    UNUSED_PARAMETER(p_context);
+
+    switch (p_ble_evt->header.evt_id)
+    {
+    case BLE_GAP_EVT_CONNECTED:
+        conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
+        notifications_enabled = false;
+        break;
+
+    case BLE_GAP_EVT_DISCONNECTED:
+        conn_handle = BLE_CONN_HANDLE_INVALID;
+        notifications_enabled = false;
+        break;
+
+    case BLE_GATTS_EVT_WRITE:
+    {
+        ble_gatts_evt_write_t const *p_write = &p_ble_evt->evt.gatts_evt.params.write;
+
+        if ((p_write->handle == loc_speed_handles.cccd_handle) && (2U == p_write->len))
+        {
+            notifications_enabled = ble_srv_is_notification_enabled(p_write->data);
+        }
+    } break;
+
+    default:
+        break;
+    }
+}
+
+/**@brief Adds the LN Feature and Location and Speed characteristics. */
+static void characteristics_add(void)
+{
+    uint32_t err_code;
+    uint8_t feature[sizeof(uint32_t)];
+    ble_add_char_params_t add_char_params;
+
+    (void)uint32_encode(LN_FEATURE_SPEED_SUPPORTED | LN_FEATURE_LOCATION_SUPPORTED |
+                        LN_FEATURE_ELEVATION_SUPPORTED | LN_FEATURE_HEADING_SUPPORTED, feature);
+
+    memset(&add_char_params, 0, sizeof(add_char_params));
+    add_char_params.uuid = BLE_UUID_LN_FEATURE_CHAR;
+    add_char_params.max_len = sizeof(feature);
+    add_char_params.init_len = sizeof(feature);
+    add_char_params.p_init_value = feature;
+    add_char_params.char_props.read = 1U;
+    add_char_params.read_access = SEC_OPEN;
+
+    err_code = characteristic_add(service_handle, &add_char_params, &feature_handles);
+    APP_ERROR_CHECK(err_code);
+
+    memset(&add_char_params, 0, sizeof(add_char_params));
+    add_char_params.uuid = BLE_UUID_LOCATION_AND_SPEED_CHAR;
+    add_char_params.max_len = LOC_SPEED_MAX_LENGTH;
+    add_char_params.is_var_len = true;
+    add_char_params.char_props.notify = 1U;
+    add_char_params.cccd_write_access = SEC_OPEN;
+
+    err_code = characteristic_add(service_handle, &add_char_params, &loc_speed_handles);
+    APP_ERROR_CHECK(err_code);
+}
+
+/**@brief Encodes a Location and Speed characteristic value, little endian.
+ *
+ * @details Speed, elevation and heading are included if reported by the receiver. UTC time is
+ *          left out, so the value fits into a notification at the default ATT MTU.
+ *
+ * @param[in]   location_record Location record.
+ * @param[out]  buffer          Buffer of at least LOC_SPEED_MAX_LENGTH bytes.
+ *
+ * @returns Length of the value.
+ */
+static uint8_t loc_speed_encode(const LocationRecordType *location_record, uint8_t *buffer)
+{
+    uint8_t length = sizeof(uint16_t);
+    uint16_t flags = LOC_SPEED_FLAG_LOCATION_PRESENT | LOC_SPEED_FLAG_POSITION_OK;
+
+    // Fields follow in the order of their flags
+    if (location_record->fields & LOCATION_FIELD_SPEED)
+    {
+        flags |= LOC_SPEED_FLAG_SPEED_PRESENT;
+        length += uint16_encode(location_record->speed, &buffer[length]);
+    }
+    length += uint32_encode((uint32_t)(location_record->position.latitude * LN_COORDINATE_SCALE), &buffer[length]);
+    length += uint32_encode((uint32_t)(location_record->position.longitude * LN_COORDINATE_SCALE), &buffer[length]);
+    if (location_record->fields & LOCATION_FIELD_ALTITUDE)
+    {
+        flags |= LOC_SPEED_FLAG_ELEVATION_PRESENT;
+        length += uint24_encode((uint32_t)(location_record->altitude / LN_ELEVATION_DIVISOR), &buffer[length]);
+    }
+    if (location_record->fields & LOCATION_FIELD_COURSE)
+    {
+        flags |= LOC_SPEED_FLAG_HEADING_PRESENT;
+        length += uint16_encode(location_record->course, &buffer[length]);
+    }
+    (void)uint16_encode(flags, buffer);
+
+    return length;
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#ifndef NAVIGATION_SERVICE_H__
+#define NAVIGATION_SERVICE_H__
+
+#include <stdint.h>
+
+#define BLE_UUID_LOCATION_NAVIGATION_SERVICE    0x1819U     /**< Location and Navigation Service. */
+#define BLE_UUID_LN_FEATURE_CHAR                0x2A6AU     /**< LN Feature characteristic. */
+#define BLE_UUID_LOCATION_AND_SPEED_CHAR        0x2A67U     /**< Location and Speed characteristic. */
+
+void navigation_service_init(void);
+uint32_t navigation_service_notifications_dropped(void);
+
+#endif // NAVIGATION_SERVICE_H__
\ No newline at end of file
@@ -0,0 +1,732 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include "nmea_parser.h"
+
+#define NMEA_START                  '$'
+#define NMEA_CHECKSUM_START         '*'
+#define NMEA_FIELD_SEPARATOR        ','
+#define NMEA_MAX_SENTENCE_LENGTH    82U     /**< Maximum sentence length including '$' and CR LF. */
+#define NMEA_ADDRESS_LENGTH         5U      /**< Talker identifier and sentence formatter. */
+#define NMEA_MAX_INTEGER            99999999UL
+
+#define FRACTION_DIGITS             6U      /**< Number of fractional digits kept for numeric fields. */
+#define MINUTES_PER_DEGREE          60U
+#define MAX_ABS_LATITUDE            90U
+#define MAX_ABS_LONGITUDE           180U
+#define MAX_ALTITUDE                100000UL    /**< Altitude limit in m, far above any receiver limit. */
+#define MAX_COURSE                  36000UL     /**< Course limit in 0.01 degrees. */
+#define MAX_DOP                     655UL       /**< DOP values above are saturated. */
+#define CM_PER_S_PER_KNOT_E6        51444444ULL /**< 1 knot is 1852 m per hour, scaled by 1e6. */
+#define MAX_SPEED_KNOTS             1274UL      /**< Speeds above exceed the record range. */
+#define MS_PER_SECOND               1000UL
+
+#define NMEA_FORMATTER(a, b, c)     (((uint32_t)(a) << 16) | ((uint32_t)(b) << 8) | (uint32_t)(c))
+
+#define POSITION_LATITUDE           0x01U
+#define POSITION_LATITUDE_SIGN      0x02U
+#define POSITION_LONGITUDE          0x04U
+#define POSITION_LONGITUDE_SIGN     0x08U
+#define POSITION_COMPLETE           0x0FU
+
+typedef enum NmeaState
+{
+    NMEA_STATE_IDLE,
+    NMEA_STATE_ADDRESS,
+    NMEA_STATE_FIELDS,
+    NMEA_STATE_CHECKSUM_HIGH,
+    NMEA_STATE_CHECKSUM_LOW
+} NmeaStateType;
+
+typedef enum NmeaSentence
+{
+    NMEA_SENTENCE_GGA,
+    NMEA_SENTENCE_RMC,
+    NMEA_SENTENCE_GLL,
+    NMEA_SENTENCE_VTG,
+    NMEA_SENTENCE_GSA,
+    NMEA_SENTENCE_COUNT
+} NmeaSentenceType;
+
+typedef enum NmeaField
+{
+    NMEA_FIELD_IGNORE,
+    NMEA_FIELD_LATITUDE,
+    NMEA_FIELD_NORTH_SOUTH,
+    NMEA_FIELD_LONGITUDE,
+    NMEA_FIELD_EAST_WEST,
+    NMEA_FIELD_FIX_QUALITY,
+    NMEA_FIELD_SATELLITES,
+    NMEA_FIELD_STATUS,
+    NMEA_FIELD_TIME,
+    NMEA_FIELD_DATE,
+    NMEA_FIELD_ALTITUDE,
+    NMEA_FIELD_SPEED,
+    NMEA_FIELD_COURSE,
+    NMEA_FIELD_HDOP,
+    NMEA_FIELD_PDOP,
+    NMEA_FIELD_FIX_MODE
+} NmeaFieldType;
+
+#define NMEA_MAX_FIELDS             17U     /**< Number of leading fields evaluated per sentence. */
+
+/**@brief Meaning of the fields of each supported sentence, index 0 is the address field.
+ *
+ * @details Speed is taken in knots. Fields not listed are ignored.
+ */
+static const uint8_t nmea_field_map[NMEA_SENTENCE_COUNT][NMEA_MAX_FIELDS] =
+{
+    [NMEA_SENTENCE_GGA] = { [1U] = NMEA_FIELD_TIME, [2U] = NMEA_FIELD_LATITUDE, [3U] = NMEA_FIELD_NORTH_SOUTH,
+                            [4U] = NMEA_FIELD_LONGITUDE, [5U] = NMEA_FIELD_EAST_WEST, [6U] = NMEA_FIELD_FIX_QUALITY,
+                            [7U] = NMEA_FIELD_SATELLITES, [8U] = NMEA_FIELD_HDOP, [9U] = NMEA_FIELD_ALTITUDE },
+    [NMEA_SENTENCE_RMC] = { [1U] = NMEA_FIELD_TIME, [2U] = NMEA_FIELD_STATUS, [3U] = NMEA_FIELD_LATITUDE,
+                            [4U] = NMEA_FIELD_NORTH_SOUTH, [5U] = NMEA_FIELD_LONGITUDE, [6U] = NMEA_FIELD_EAST_WEST,
+                            [7U] = NMEA_FIELD_SPEED, [8U] = NMEA_FIELD_COURSE, [9U] = NMEA_FIELD_DATE },
+    [NMEA_SENTENCE_GLL] = { [1U] = NMEA_FIELD_LATITUDE, [2U] = NMEA_FIELD_NORTH_SOUTH, [3U] = NMEA_FIELD_LONGITUDE,
+                            [4U] = NMEA_FIELD_EAST_WEST, [5U] = NMEA_FIELD_TIME, [6U] = NMEA_FIELD_STATUS },
+    [NMEA_SENTENCE_VTG] = { [1U] = NMEA_FIELD_COURSE, [5U] = NMEA_FIELD_SPEED },
+    [NMEA_SENTENCE_GSA] = { [2U] = NMEA_FIELD_FIX_MODE, [15U] = NMEA_FIELD_PDOP, [16U] = NMEA_FIELD_HDOP }
+};
+
+static const uint32_t pow10_table[FRACTION_DIGITS + 1U] =
+{
+    1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL
+};
+
+/**@brief Parser context, persists between calls while a sentence is being received. */
+typedef struct NmeaParser
+{
+    NmeaStateType state;
+    NmeaSentenceType sentence;
+    uint8_t length;             /**< Bytes received of the current sentence. */
+    uint8_t checksum;           /**< Running XOR over all bytes between '$' and '*'. */
+    uint8_t received_checksum;
+    uint8_t field;              /**< Index of the current field, 0 is the address. */
+    uint32_t formatter;         /**< Sentence formatter, collected from the address field. */
+
+    // Current field
+    uint32_t integer;
+    uint32_t fraction;
+    uint8_t fraction_digits;
+    uint8_t field_length;
+    bool in_fraction;
+    bool negative;
+    bool field_valid;
+    uint8_t field_char;
+
+    // Values of the current sentence, committed after checksum verification
+    uint32_t latitude;          /**< Absolute latitude in micro-degrees. */
+    uint32_t longitude;         /**< Absolute longitude in micro-degrees. */
+    int8_t latitude_sign;
+    int8_t longitude_sign;
+    uint8_t position_flags;
+    bool fix_valid;
+    uint8_t fix_mode;           /**< Fix dimension reported by GSA. */
+    LocationRecordType record;  /**< Optional fields of the current sentence. */
+} NmeaParserType;
+
+static NmeaParserType parser;
+static LocationRecordType epoch;    /**< Fields collected from the verified sentences of the current fix. */
+static uint8_t fix_dimension;       /**< Fix dimension of the last verified GSA sentence. */
+
+const GnssProtocolType nmea_protocol =
+{
+    .reset  = nmea_parser_reset,
+    .parse  = nmea_parser_parse,
+    .status = nmea_parser_status
+};
+
+// Private method declarations
+static void sentence_start(void);
+static void field_start(void);
+static void field_char(uint8_t c);
+static bool field_end(void);
+static bool address_end(void);
+static bool minutes_to_micro_degrees(uint32_t max_degrees, uint32_t *micro_degrees);
+static bool optional_field_end(uint8_t field_type);
+static uint32_t field_fraction(uint8_t digits);
+static void epoch_update(void);
+static GnssParseResultType sentence_end(LocationRecordType *record);
+static int8_t hex_value(uint8_t c);
+
+/*
+ * Public methods
+ */
+
+/**@brief Resets the parser, any partially received sentence is discarded. */
+void nmea_parser_reset(void)
+{
+    parser.state = NMEA_STATE_IDLE;
+    location_record_init(&epoch);
+    epoch.fix_type = LOCATION_FIX_NONE;
+    fix_dimension = LOCATION_FIX_NONE;
+}
+
+/**@brief Feeds one received byte to the NMEA parser.
+ *
+ * @details Numeric fields are converted while they are received and the checksum is verified on
+ *          the fly, so no sentence needs to be buffered. Supported sentences are GGA, RMC, GLL,
+ *          VTG and GSA of any talker. The optional fields of all verified sentences are collected,
+ *          so a record carries the latest time, speed, course, altitude, DOP and satellites
+ *          reported by the receiver. The location record is only written if the checksum
+ *          matches and a sentence with position reports a valid fix.
+ *
+ * @param[in]   c           Received byte.
+ * @param[out]  record      Location record updated on a complete, valid sentence.
+ *
+ * @returns Parse result, see @ref GnssParseResultType.
+ */
+GnssParseResultType nmea_parser_parse(uint8_t c, LocationRecordType *record)
+{
+    GnssParseResultType result = GNSS_PARSE_PENDING;
+    int8_t nibble;
+
+    if (NMEA_START == c)
+    {
+        result = (NMEA_STATE_IDLE == parser.state) ? GNSS_PARSE_PENDING : GNSS_PARSE_ERROR;
+        sentence_start();
+        return result;
+    }
+
+    if (NMEA_STATE_IDLE == parser.state)
+    {
+        return GNSS_PARSE_PENDING;
+    }
+
+    if (++parser.length > NMEA_MAX_SENTENCE_LENGTH)
+    {
+        parser.state = NMEA_STATE_IDLE;
+        return GNSS_PARSE_ERROR;
+    }
+
+    switch (parser.state)
+    {
+    case NMEA_STATE_ADDRESS:
+    case NMEA_STATE_FIELDS:
+        if (NMEA_CHECKSUM_START == c)
+        {
+            if ((NMEA_STATE_FIELDS == parser.state) && field_end())
+            {
+                parser.state = NMEA_STATE_CHECKSUM_HIGH;
+            }
+            else
+            {
+                parser.state = NMEA_STATE_IDLE;
+                result = GNSS_PARSE_ERROR;
+            }
+        }
+        else if ((c < ' ') || (c > '~'))
+        {
+            // Control characters are not allowed within a sentence
+            parser.state = NMEA_STATE_IDLE;
+            result = GNSS_PARSE_ERROR;
+        }
+        else
+        {
+            parser.checksum ^= c;
+
+            if (NMEA_FIELD_SEPARATOR == c)
+            {
+                if (NMEA_STATE_ADDRESS == parser.state)
+                {
+                    // Remainder of unsupported sentences is skipped
+                    if (!address_end())
+                    {
+                        parser.state = NMEA_STATE_IDLE;
+                    }
+                }
+                else if (!field_end())
+                {
+                    parser.state = NMEA_STATE_IDLE;
+                    result = GNSS_PARSE_ERROR;
+                }
+
+                ++parser.field;
+                field_start();
+            }
+            else if (NMEA_STATE_ADDRESS == parser.state)
+            {
+                parser.formatter = (parser.formatter << 8) | c;
+                ++parser.field_length;
+            }
+            else
+            {
+                field_char(c);
+            }
+        }
+        break;
+
+    case NMEA_STATE_CHECKSUM_HIGH:
+        nibble = hex_value(c);
+        if (nibble >= 0)
+        {
+            parser.received_checksum = (uint8_t)nibble << 4;
+            parser.state = NMEA_STATE_CHECKSUM_LOW;
+        }
+        else
+        {
+            parser.state = NMEA_STATE_IDLE;
+            result = GNSS_PARSE_ERROR;
+        }
+        break;
+
+    case NMEA_STATE_CHECKSUM_LOW:
+        nibble = hex_value(c);
+        parser.state = NMEA_STATE_IDLE;
+        if (nibble >= 0)
+        {
+            parser.received_checksum |= (uint8_t)nibble;
+            result = sentence_end(record);
+        }
+        else
+        {
+            result = GNSS_PARSE_ERROR;
+        }
+        break;
+
+    default:
+        parser.state = NMEA_STATE_IDLE;
+        break;
+    }
+
+    return result;
+}
+
+/**@brief Gets the receiver status of the last verified sentences.
+ *
+ * @details GGA reports whether there is a fix, GSA its dimension. Without GSA a fix is reported
+ *          as LOCATION_FIX_VALID.
+ *
+ * @param[out]  status      Receiver status.
+ */
+void nmea_parser_status(GnssStatusType *status)
+{
+    status->fix_type = epoch.fix_type;
+    status->satellites = epoch.satellites;
+}
+
+/*
+ * Private methods
+ */
+
+static void sentence_start(void)
+{
+    parser.state = NMEA_STATE_ADDRESS;
+    parser.length = 1U;
+    parser.checksum = 0U;
+    parser.field = 0U;
+    parser.formatter = 0UL;
+    parser.position_flags = 0U;
+    parser.fix_valid = false;
+    parser.fix_mode = LOCATION_FIX_NONE;
+    parser.record.fields = 0U;
+    field_start();
+}
+
+static void field_start(void)
+{
+    parser.integer = 0UL;
+    parser.fraction = 0UL;
+    parser.fraction_digits = 0U;
+    parser.field_length = 0U;
+    parser.in_fraction = false;
+    parser.negative = false;
+    parser.field_valid = true;
+    parser.field_char = 0U;
+}
+
+/**@brief Accumulates one character of the current field. */
+static void field_char(uint8_t c)
+{
+    if (0U == parser.field_length)
+    {
+        parser.field_char = c;
+    }
+    ++parser.field_length;
+
+    if ((c >= '0') && (c <= '9'))
+    {
+        if (parser.in_fraction)
+        {
+            // Additional fractional digits are beyond the precision of the location data
+            if (parser.fraction_digits < FRACTION_DIGITS)
+            {
+                parser.fraction = (parser.fraction * 10U) + (c - '0');
+                ++parser.fraction_digits;
+            }
+        }
+        else if (parser.integer <= NMEA_MAX_INTEGER)
+        {
+            parser.integer = (parser.integer * 10U) + (c - '0');
+        }
+        else
+        {
+            parser.field_valid = false;
+        }
+    }
+    else if (('.' == c) && !parser.in_fraction)
+    {
+        parser.in_fraction = true;
+    }
+    else if (('-' == c) && (1U == parser.field_length))
+    {
+        parser.negative = true;
+    }
+    else
+    {
+        parser.field_valid = false;
+    }
+}
+
+/**@brief Evaluates the address field.
+ *
+ * @returns true if the sentence is supported, false otherwise.
+ */
+static bool address_end(void)
+{
+    bool is_supported = true;
+
+    if (NMEA_ADDRESS_LENGTH != parser.field_length)
+    {
+        return false;
+    }
+
+    switch (parser.formatter & 0x00FFFFFFUL)
+    {
+    case NMEA_FORMATTER('G', 'G', 'A'):
+        parser.sentence = NMEA_SENTENCE_GGA;
+        break;
+
+    case NMEA_FORMATTER('R', 'M', 'C'):
+        parser.sentence = NMEA_SENTENCE_RMC;
+        break;
+
+    case NMEA_FORMATTER('G', 'L', 'L'):
+        parser.sentence = NMEA_SENTENCE_GLL;
+        break;
+
+    case NMEA_FORMATTER('V', 'T', 'G'):
+        parser.sentence = NMEA_SENTENCE_VTG;
+        break;
+
+    case NMEA_FORMATTER('G', 'S', 'A'):
+        parser.sentence = NMEA_SENTENCE_GSA;
+        break;
+
+    default:
+        is_supported = false;
+        break;
+    }
+
+    if (is_supported)
+    {
+        parser.state = NMEA_STATE_FIELDS;
+    }
+
+    return is_supported;
+}
+
+/**@brief Evaluates the completed field according to the current sentence.
+ *
+ * @returns false if the field is malformed, true otherwise.
+ */
+static bool field_end(void)
+{
+    bool is_valid = true;
+    uint8_t field_type = NMEA_FIELD_IGNORE;
+
+    if (parser.field < NMEA_MAX_FIELDS)
+    {
+        field_type = nmea_field_map[parser.sentence][parser.field];
+    }
+
+    // Empty fields are valid and simply carry no information
+    if (0U == parser.field_length)
+    {
+        return true;
+    }
+
+    // Only altitude may be negative
+    if (parser.negative && (NMEA_FIELD_ALTITUDE != field_type))
+    {
+        return false;
+    }
+
+    switch (field_type)
+    {
+    case NMEA_FIELD_LATITUDE:
+        is_valid = minutes_to_micro_degrees(MAX_ABS_LATITUDE, &parser.latitude);
+        parser.position_flags |= POSITION_LATITUDE;
+        break;
+
+    case NMEA_FIELD_LONGITUDE:
+        is_valid = minutes_to_micro_degrees(MAX_ABS_LONGITUDE, &parser.longitude);
+        parser.position_flags |= POSITION_LONGITUDE;
+        break;
+
+    case NMEA_FIELD_NORTH_SOUTH:
+        is_valid = ('N' == parser.field_char) || ('S' == parser.field_char);
+        parser.latitude_sign = ('S' == parser.field_char) ? -1 : 1;
+        parser.position_flags |= POSITION_LATITUDE_SIGN;
+        break;
+
+    case NMEA_FIELD_EAST_WEST:
+        is_valid = ('E' == parser.field_char) || ('W' == parser.field_char);
+        parser.longitude_sign = ('W' == parser.field_char) ? -1 : 1;
+        parser.position_flags |= POSITION_LONGITUDE_SIGN;
+        break;
+
+    case NMEA_FIELD_FIX_QUALITY:
+        is_valid = parser.field_valid;
+        parser.fix_valid = (parser.integer > 0U);
+        break;
+
+    case NMEA_FIELD_STATUS:
+        parser.fix_valid = ('A' == parser.field_char);
+        break;
+
+    case NMEA_FIELD_FIX_MODE:
+        is_valid = parser.field_valid && (parser.integer <= LOCATION_FIX_3D);
+        parser.fix_mode = (uint8_t)parser.integer;
+        break;
+
+    case NMEA_FIELD_IGNORE:
+        break;
+
+    default:
+        is_valid = parser.field_valid && optional_field_end(field_type);
+        break;
+    }
+
+    return is_valid;
+}
+
+/**@brief Converts the current field to an optional field of the location record.
+ *
+ * @returns false if the value is out of range, true otherwise.
+ */
+static bool optional_field_end(uint8_t field_type)
+{
+    LocationRecordType *record = &parser.record;
+    uint32_t value = parser.integer;
+    uint8_t field;
+
+    switch (field_type)
+    {
+    case NMEA_FIELD_TIME:
+    {
+        // hhmmss.ss
+        uint32_t hours = value / 10000U;
+        uint32_t minutes = (value / 100U) % 100U;
+        uint32_t seconds = value % 100U;
+
+        if ((hours >= 24U) || (minutes >= 60U) || (seconds > 60U))
+        {
+            return false;
+        }
+        record->time = ((((hours * 60U) + minutes) * 60U) + seconds) * MS_PER_SECOND + field_fraction(3U);
+        field = LOCATION_FIELD_TIME;
+    } break;
+
+    case NMEA_FIELD_DATE:
+    {
+        // ddmmyy, years from 2000 on
+        uint32_t day = value / 10000U;
+        uint32_t month = (value / 100U) % 100U;
+
+        if ((day < 1U) || (day > 31U) || (month < 1U) || (month > 12U))
+        {
+            return false;
+        }
+        record->date = location_date_to_days(2000U + (value % 100U), month, day);
+        field = LOCATION_FIELD_DATE;
+    } break;
+
+    case NMEA_FIELD_ALTITUDE:
+        if (value > MAX_ALTITUDE)
+        {
+            return false;
+        }
+        value = (value * MS_PER_SECOND) + field_fraction(3U);
+        record->altitude = parser.negative ? -(int32_t)value : (int32_t)value;
+        field = LOCATION_FIELD_ALTITUDE;
+        break;
+
+    case NMEA_FIELD_SPEED:
+    {
+        // Micro knots to cm/s, speeds beyond the record range saturate
+        uint64_t speed = (value > MAX_SPEED_KNOTS) ? UINT16_MAX :
+                         ((((uint64_t)value * pow10_table[FRACTION_DIGITS]) + field_fraction(FRACTION_DIGITS)) *
+                          CM_PER_S_PER_KNOT_E6) / ((uint64_t)pow10_table[FRACTION_DIGITS] * pow10_table[FRACTION_DIGITS]);
+
+        record->speed = (speed > UINT16_MAX) ? UINT16_MAX : (uint16_t)speed;
+        field = LOCATION_FIELD_SPEED;
+    } break;
+
+    case NMEA_FIELD_COURSE:
+        // Checked before scaling, large courses would overflow
+        if (value > (MAX_COURSE / 100U))
+        {
+            return false;
+        }
+        value = (value * 100U) + field_fraction(2U);
+        if (value > MAX_COURSE)
+        {
+            return false;
+        }
+        record->course = (uint16_t)(value % MAX_COURSE);
+        field = LOCATION_FIELD_COURSE;
+        break;
+
+    case NMEA_FIELD_SATELLITES:
+        if (value > UINT8_MAX)
+        {
+            return false;
+        }
+        record->satellites = (uint8_t)value;
+        field = LOCATION_FIELD_SATELLITES;
+        break;
+
+    case NMEA_FIELD_HDOP:
+    case NMEA_FIELD_PDOP:
+        value = (value > MAX_DOP) ? UINT16_MAX : ((value * 100U) + field_fraction(2U));
+        if (NMEA_FIELD_HDOP == field_type)
+        {
+            record->hdop = (value > UINT16_MAX) ? UINT16_MAX : (uint16_t)value;
+            field = LOCATION_FIELD_HDOP;
+        }
+        else
+        {
+            record->pdop = (value > UINT16_MAX) ? UINT16_MAX : (uint16_t)value;
+            field = LOCATION_FIELD_PDOP;
+        }
+        break;
+
+    default:
+        return true;
+    }
+
+    record->fields |= field;
+
+    return true;
+}
+
+/**@brief Returns the fractional digits of the current field as value with the given digits. */
+static uint32_t field_fraction(uint8_t digits)
+{
+    if (parser.fraction_digits > digits)
+    {
+        return parser.fraction / pow10_table[parser.fraction_digits - digits];
+    }
+
+    return parser.fraction * pow10_table[digits - parser.fraction_digits];
+}
+
+/**@brief Converts the current (d)ddmm.mmmmmm field to micro-degrees. */
+static bool minutes_to_micro_degrees(uint32_t max_degrees, uint32_t *micro_degrees)
+{
+    uint32_t degrees = parser.integer / 100U;
+    uint32_t minutes = parser.integer % 100U;
+    uint32_t fraction = parser.fraction * pow10_table[FRACTION_DIGITS - parser.fraction_digits];
+
+    // Checked before scaling, large degrees would overflow
+    if (!parser.field_valid || (degrees > max_degrees) || (minutes >= MINUTES_PER_DEGREE))
+    {
+        return false;
+    }
+
+    *micro_degrees = (degrees * MICRO_DEGREES_PER_DEGREE) +
+                     ((minutes * MICRO_DEGREES_PER_DEGREE) + fraction + (MINUTES_PER_DEGREE / 2U)) / MINUTES_PER_DEGREE;
+
+    return (*micro_degrees <= (max_degrees * MICRO_DEGREES_PER_DEGREE));
+}
+
+/**@brief Verifies the checksum and commits the sentence to the location record. */
+static GnssParseResultType sentence_end(LocationRecordType *record)
+{
+    if (parser.received_checksum != parser.checksum)
+    {
+        return GNSS_PARSE_ERROR;
+    }
+
+    epoch_update();
+
+    if (!parser.fix_valid || (POSITION_COMPLETE != parser.position_flags) || (NULL == record))
+    {
+        return GNSS_PARSE_IGNORED;
+    }
+
+    epoch.position.latitude  = parser.latitude_sign * (int32_t)parser.latitude;
+    epoch.position.longitude = parser.longitude_sign * (int32_t)parser.longitude;
+    *record = epoch;
+
+    return GNSS_PARSE_LOCATION;
+}
+
+/**@brief Merges the optional fields and fix state of a verified sentence into the epoch record.
+ *
+ * @details Fields reported by one sentence stay valid until a sentence reports the fix lost, then
+ *          only time and date are kept.
+ */
+static void epoch_update(void)
+{
+    const LocationRecordType *sentence = &parser.record;
+    uint8_t fields = sentence->fields;
+
+    if (fields & LOCATION_FIELD_TIME)       { epoch.time = sentence->time; }
+    if (fields & LOCATION_FIELD_DATE)       { epoch.date = sentence->date; }
+    if (fields & LOCATION_FIELD_ALTITUDE)   { epoch.altitude = sentence->altitude; }
+    if (fields & LOCATION_FIELD_SPEED)      { epoch.speed = sentence->speed; }
+    if (fields & LOCATION_FIELD_COURSE)     { epoch.course = sentence->course; }
+    if (fields & LOCATION_FIELD_HDOP)       { epoch.hdop = sentence->hdop; }
+    if (fields & LOCATION_FIELD_PDOP)       { epoch.pdop = sentence->pdop; }
+    if (fields & LOCATION_FIELD_SATELLITES) { epoch.satellites = sentence->satellites; }
+    epoch.fields |= fields;
+
+    switch (parser.sentence)
+    {
+    case NMEA_SENTENCE_GSA:
+        fix_dimension = parser.fix_mode;
+        if (LOCATION_FIX_NONE != epoch.fix_type)
+        {
+            epoch.fix_type = (fix_dimension >= LOCATION_FIX_2D) ? fix_dimension : LOCATION_FIX_NONE;
+        }
+        break;
+
+    case NMEA_SENTENCE_GGA:
+    case NMEA_SENTENCE_RMC:
+    case NMEA_SENTENCE_GLL:
+        if (!parser.fix_valid)
+        {
+            epoch.fix_type = LOCATION_FIX_NONE;
+            epoch.fields &= (LOCATION_FIELD_TIME | LOCATION_FIELD_DATE);
+        }
+        else
+        {
+            epoch.fix_type = (fix_dimension >= LOCATION_FIX_2D) ? fix_dimension : LOCATION_FIX_VALID;
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+static int8_t hex_value(uint8_t c)
+{
+    int8_t value = -1;
+
+    if ((c >= '0') && (c <= '9'))
+    {
+        value = c - '0';
+    }
+    else if ((c >= 'A') && (c <= 'F'))
+    {
+        value = c - 'A' + 10;
+    }
+    else if ((c >= 'a') && (c <= 'f'))
+    {
+        value = c - 'a' + 10;
+    }
+
+    return value;
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#ifndef NMEA_PARSER_H__
+#define NMEA_PARSER_H__
+
+#include <stdint.h>
+#include "gnss_protocol.h"
+
+extern const GnssProtocolType nmea_protocol;
+
+void nmea_parser_reset(void);
+GnssParseResultType nmea_parser_parse(uint8_t c, LocationRecordType *record);
+void nmea_parser_status(GnssStatusType *status);
+
+#endif // NMEA_PARSER_H__
\ No newline at end of file
@@ -141,6 +141,13 @@
 #define BLE_RACP_ENABLED 0
 #endif
 
+// <q> NRF_BLE_GATT_ENABLED  - nrf_ble_gatt - GATT module
+ 
+
+#ifndef NRF_BLE_GATT_ENABLED
+#define NRF_BLE_GATT_ENABLED 1
+#endif
+
 // <e> NRF_BLE_QWR_ENABLED - nrf_ble_qwr - Queued writes support module (prepare/execute write)
 //==========================================================
 #ifndef NRF_BLE_QWR_ENABLED
@@ -4664,11 +4671,11 @@
 // </e>
 
 #ifndef APP_FIFO_ENABLED
-#define APP_FIFO_ENABLED 1
+#define APP_FIFO_ENABLED 0
 #endif
 
 #ifndef APP_UART_ENABLED
-#define APP_UART_ENABLED 1
+#define APP_UART_ENABLED 0
 #endif
 
 #ifndef APP_UART_DRIVER_INSTANCE
@@ -4981,7 +4988,7 @@
  
 
 #ifndef PPI_ENABLED
-#define PPI_ENABLED 0
+#define PPI_ENABLED 1
 #endif
 
 // <e> PWM_ENABLED - nrf_drv_pwm - PWM peripheral driver - legacy layer
@@ -5662,7 +5669,7 @@
 // <e> TIMER_ENABLED - nrf_drv_timer - TIMER periperal driver - legacy layer
 //==========================================================
 #ifndef TIMER_ENABLED
-#define TIMER_ENABLED 0
+#define TIMER_ENABLED 1
 #endif
 // <o> TIMER_DEFAULT_CONFIG_FREQUENCY  - Timer frequency if in Timer mode
  
@@ -5729,14 +5736,14 @@
  
 
 #ifndef TIMER1_ENABLED
-#define TIMER1_ENABLED 0
+#define TIMER1_ENABLED 1
 #endif
 
 // <q> TIMER2_ENABLED  - Enable TIMER2 instance
  
 
 #ifndef TIMER2_ENABLED
-#define TIMER2_ENABLED 0
+#define TIMER2_ENABLED 1
 #endif
 
 // <q> TIMER3_ENABLED  - Enable TIMER3 instance
@@ -11407,13 +11414,21 @@
 // <i> Requested BLE GAP data length to be negotiated.
 
 #ifndef NRF_SDH_BLE_GAP_DATA_LENGTH
+#if BEACON_CONNECTABLE
+#define NRF_SDH_BLE_GAP_DATA_LENGTH 251
+#else
 #define NRF_SDH_BLE_GAP_DATA_LENGTH 27
 #endif
+#endif
 
 // <o> NRF_SDH_BLE_PERIPHERAL_LINK_COUNT - Maximum number of peripheral links. 
 #ifndef NRF_SDH_BLE_PERIPHERAL_LINK_COUNT
+#if BEACON_CONNECTABLE
+#define NRF_SDH_BLE_PERIPHERAL_LINK_COUNT 1
+#else
 #define NRF_SDH_BLE_PERIPHERAL_LINK_COUNT 0
 #endif
+#endif
 
 // <o> NRF_SDH_BLE_CENTRAL_LINK_COUNT - Maximum number of central links. 
 #ifndef NRF_SDH_BLE_CENTRAL_LINK_COUNT
@@ -11431,23 +11446,39 @@
 // <i> The time set aside for this connection on every connection interval in 1.25 ms units.
 
 #ifndef NRF_SDH_BLE_GAP_EVENT_LENGTH
+#if BEACON_CONNECTABLE
+#define NRF_SDH_BLE_GAP_EVENT_LENGTH 24
+#else
 #define NRF_SDH_BLE_GAP_EVENT_LENGTH 6
 #endif
+#endif
 
 // <o> NRF_SDH_BLE_GATT_MAX_MTU_SIZE - Static maximum MTU size. 
 #ifndef NRF_SDH_BLE_GATT_MAX_MTU_SIZE
+#if BEACON_CONNECTABLE
+#define NRF_SDH_BLE_GATT_MAX_MTU_SIZE 247
+#else
 #define NRF_SDH_BLE_GATT_MAX_MTU_SIZE 23
 #endif
+#endif
 
 // <o> NRF_SDH_BLE_GATTS_ATTR_TAB_SIZE - Attribute Table size in bytes. The size must be a multiple of 4. 
 #ifndef NRF_SDH_BLE_GATTS_ATTR_TAB_SIZE
+#if BEACON_CONNECTABLE
+#define NRF_SDH_BLE_GATTS_ATTR_TAB_SIZE 1408
+#else
 #define NRF_SDH_BLE_GATTS_ATTR_TAB_SIZE 248
 #endif
+#endif
 
 // <o> NRF_SDH_BLE_VS_UUID_COUNT - The number of vendor-specific UUIDs. 
 #ifndef NRF_SDH_BLE_VS_UUID_COUNT
+#if BEACON_CONNECTABLE
+#define NRF_SDH_BLE_VS_UUID_COUNT 1
+#else
 #define NRF_SDH_BLE_VS_UUID_COUNT 0
 #endif
+#endif
 
 // <q> NRF_SDH_BLE_SERVICE_CHANGED  - Include the Service Changed characteristic in the Attribute Table.
  
@@ -0,0 +1,310 @@
+#include <string.h>
+#include "nordic_common.h"
+#include "app_error.h"
+#include "app_timer.h"
+#include "app_util_platform.h"
+#include "nrf_sdh_ble.h"
+#include "ble_srv_common.h"
+#include "beacon_config.h"
+#include "track_service.h"
+#include "location_service.h"
+
+#define ATT_HEADER_LENGTH               3U      /**< Opcode and handle of a notification. */
+#define DATA_MAX_LENGTH                 (NRF_SDH_BLE_GATT_MAX_MTU_SIZE - ATT_HEADER_LENGTH)
+#define CONTROL_MAX_LENGTH              5U
+#define APP_TIMER_TICK_FREQ             (APP_TIMER_CLOCK_FREQ / (APP_TIMER_CONFIG_RTC_FREQUENCY + 1U))
+
+/**@brief Fix kept for download. */
+typedef struct TrackRecord
+{
+    LocationDataType location;
+    uint32_t time;              /**< Time of the fix in BEACON_TRACK_TIME_UNIT_MS. */
+} TrackRecordType;
+
+// Private data
+static int8_t ls_handle;                                    /**< Location service handle. */
+static uint8_t uuid_type;
+static uint16_t service_handle;
+static ble_gatts_char_handles_t control_handles;
+static ble_gatts_char_handles_t data_handles;
+static uint16_t conn_handle = BLE_CONN_HANDLE_INVALID;
+static uint16_t data_length;                                /**< Notification length allowed by the ATT MTU. */
+static bool streaming;
+static uint32_t stream_seq;                                 /**< Sequence number of the next fix notified. */
+static TrackRecordType history[TRACK_HISTORY_SIZE];
+static uint32_t history_seq;                                /**< Sequence number of the next fix received. */
+static volatile bool pump_active;                           /**< stream_pump is running. */
+static volatile bool pump_requested;                        /**< stream_pump was called while running. */
+static uint64_t ticks;                                      /**< Time base of the fixes, extends the app_timer counter. */
+static uint32_t last_cnt;
+
+// Private method declarations
+static void track_service_accept(const LocationDataType *location_data);
+static void track_service_on_ble_evt(ble_evt_t const *p_ble_evt, void *p_context);
+static void characteristics_add(void);
+static void control_write(const uint8_t *data, uint16_t length);
+static void stream_pump(void);
+static uint32_t time_get(void);
+
+NRF_SDH_BLE_OBSERVER(track_service_observer, APP_BLE_OBSERVER_PRIO, track_service_on_ble_evt, NULL);
+
+/*
+ * Public methods
+ */
+
+/**@brief Adds the track download service to the GATT server and starts recording fixes. */
+void track_service_init(void)
+{
+    uint32_t err_code;
+    ble_uuid_t ble_uuid;
+    ble_uuid128_t base_uuid = {TRACK_SERVICE_UUID_BASE};
+
+    err_code = sd_ble_uuid_vs_add(&base_uuid, &uuid_type);
+    APP_ERROR_CHECK(err_code);
+
+    ble_uuid.type = uuid_type;
+    ble_uuid.uuid = TRACK_SERVICE_UUID;
+
+    err_code = sd_ble_gatts_service_add(BLE_GATTS_SRVC_TYPE_PRIMARY, &ble_uuid, &service_handle);
+    APP_ERROR_CHECK(err_code);
+
+    characteristics_add();
+
+    conn_handle = BLE_CONN_HANDLE_INVALID;
+    streaming = false;
+    history_seq = 0UL;
+    pump_active = false;
+    pump_requested = false;
+    ticks = 0U;
+    last_cnt = app_timer_cnt_get();
+
+    ls_handle = location_service_subscribe(&track_service_accept);
+    if (ls_handle < 0)
+    {
+        // All subscriber slots taken, see MAX_SUBSCRIBERS
+        APP_ERROR_CHECK(NRF_ERROR_NO_MEM);
+    }
+    (void)location_service_priority_set(ls_handle, LOCATION_PRIORITY_LOW);
+}
+
+/*
+ * Private methods
+ */
+
+/**@brief Subscription function for accepting new location data
+ *
+ * @details Appends the fix to the history, overwriting the oldest one, and notifies it right
+ *          away if a download has caught up with the live fixes.
+ *
+ * @param[in]   location_data   Pointer to location data.
+ */
+static void track_service_accept(const LocationDataType *location_data)
+{
+    TrackRecordType *record = &history[history_seq & (TRACK_HISTORY_SIZE - 1U)];
+
+    CRITICAL_REGION_ENTER();
+    record->location = *location_data;
+    record->time = time_get();
+    history_seq++;
+    CRITICAL_REGION_EXIT();
+
+    stream_pump();
+}
+
+/**@brief Tracks the connection, handles control point writes and refills the notification queue. */
+static void track_service_on_ble_evt(ble_evt_t const *p_ble_evt, void *p_context)
+{
+    UNUSED_PARAMETER(p_context);
+
+    switch (p_ble_evt->header.evt_id)
+    {
+    case BLE_GAP_EVT_CONNECTED:
+        conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
+        data_length = BLE_GATT_ATT_MTU_DEFAULT - ATT_HEADER_LENGTH;
+        streaming = false;
+        break;
+
+    case BLE_GAP_EVT_DISCONNECTED:
+        conn_handle = BLE_CONN_HANDLE_INVALID;
+        streaming = false;
+        break;
+
+    case BLE_GATTS_EVT_EXCHANGE_MTU_REQUEST:
+        // Answered by the GATT module with NRF_SDH_BLE_GATT_MAX_MTU_SIZE.
+        data_length = MIN(p_ble_evt->evt.gatts_evt.params.exchange_mtu_request.client_rx_mtu,
+                          NRF_SDH_BLE_GATT_MAX_MTU_SIZE) - ATT_HEADER_LENGTH;
+        break;
+
+    case BLE_GATTC_EVT_EXCHANGE_MTU_RSP:
+        data_length = MIN(p_ble_evt->evt.gattc_evt.params.exchange_mtu_rsp.server_rx_mtu,
+                          NRF_SDH_BLE_GATT_MAX_MTU_SIZE) - ATT_HEADER_LENGTH;
+        break;
+
+    case BLE_GATTS_EVT_WRITE:
+        if (p_ble_evt->evt.gatts_evt.params.write.handle == control_handles.value_handle)
+        {
+            control_write(p_ble_evt->evt.gatts_evt.params.write.data,
+                          p_ble_evt->evt.gatts_evt.params.write.len);
+        }
+        break;
+
+    case BLE_GATTS_EVT_HVN_TX_COMPLETE:
+        stream_pump();
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**@brief Adds the control point and data characteristics. */
+static void characteristics_add(void)
+{
+    uint32_t err_code;
+    ble_add_char_params_t add_char_params;
+
+    memset(&add_char_params, 0, sizeof(add_char_params));
+    add_char_params.uuid = TRACK_SERVICE_UUID_CONTROL_CHAR;
+    add_char_params.uuid_type = uuid_type;
+    add_char_params.max_len = CONTROL_MAX_LENGTH;
+    add_char_params.is_var_len = true;
+    add_char_params.char_props.write = 1U;
+    add_char_params.write_access = SEC_OPEN;
+
+    err_code = characteristic_add(service_handle, &add_char_params, &control_handles);
+    APP_ERROR_CHECK(err_code);
+
+    memset(&add_char_params, 0, sizeof(add_char_params));
+    add_char_params.uuid = TRACK_SERVICE_UUID_DATA_CHAR;
+    add_char_params.uuid_type = uuid_type;
+    add_char_params.max_len = DATA_MAX_LENGTH;
+    add_char_params.is_var_len = true;
+    add_char_params.char_props.notify = 1U;
+    add_char_params.cccd_write_access = SEC_OPEN;
+
+    err_code = characteristic_add(service_handle, &add_char_params, &data_handles);
+    APP_ERROR_CHECK(err_code);
+}
+
+/**@brief Starts or stops the download. */
+static void control_write(const uint8_t *data, uint16_t length)
+{
+    if ((CONTROL_MAX_LENGTH == length) && (TRACK_SERVICE_OP_START == data[0U]))
+    {
+        stream_seq = uint32_decode(&data[1U]);
+        streaming = true;
+        stream_pump();
+    }
+    else if ((1U == length) && (TRACK_SERVICE_OP_STOP == data[0U]))
+    {
+        streaming = false;
+    }
+}
+
+/**@brief Queues notifications back-to-back until the SoftDevice queue is full or the download
+ *        has caught up with the live fixes.
+ *
+ * @details Called from the BLE event handler on completed notifications and from the main loop
+ *          on new fixes. Only reading the history into the notification buffer is done within a
+ *          critical region, the notifications are queued outside of it. A call preempting a
+ *          running pump only requests another pass from it.
+ */
+static void stream_pump(void)
+{
+    uint32_t err_code;
+    uint8_t buffer[DATA_MAX_LENGTH];
+    ble_gatts_hvx_params_t hvx_params;
+    bool active = true;
+
+    CRITICAL_REGION_ENTER();
+    if (pump_active)
+    {
+        pump_requested = true;
+        active = false;
+    }
+    pump_active = true;
+    CRITICAL_REGION_EXIT();
+
+    while (active)
+    {
+        uint32_t start;
+        uint32_t seq = 0UL;
+        uint16_t length = 0U;
+
+        CRITICAL_REGION_ENTER();
+        if (streaming && (BLE_CONN_HANDLE_INVALID != conn_handle))
+        {
+            uint32_t oldest = (history_seq > TRACK_HISTORY_SIZE) ? (history_seq - TRACK_HISTORY_SIZE) : 0UL;
+
+            // Resume with the oldest fix kept if the requested ones were overwritten.
+            if ((int32_t)(stream_seq - oldest) < 0)
+            {
+                stream_seq = oldest;
+            }
+            if ((int32_t)(history_seq - stream_seq) > 0)
+            {
+                length = uint32_encode(stream_seq, buffer);
+                for (seq = stream_seq;
+                     (seq != history_seq) && ((length + TRACK_SERVICE_RECORD_LENGTH) <= data_length);
+                     seq++)
+                {
+                    const TrackRecordType *record = &history[seq & (TRACK_HISTORY_SIZE - 1U)];
+
+                    length += uint32_encode((uint32_t)record->location.latitude, &buffer[length]);
+                    length += uint32_encode((uint32_t)record->location.longitude, &buffer[length]);
+                    length += uint32_encode(record->time, &buffer[length]);
+                }
+            }
+        }
+        start = stream_seq;
+        CRITICAL_REGION_EXIT();
+
+        err_code = NRF_ERROR_RESOURCES;
+        if (0U != length)
+        {
+            memset(&hvx_params, 0, sizeof(hvx_params));
+            hvx_params.handle = data_handles.value_handle;
+            hvx_params.type = BLE_GATT_HVX_NOTIFICATION;
+            hvx_params.p_len = &length;
+            hvx_params.p_data = buffer;
+
+            err_code = sd_ble_gatts_hvx(conn_handle, &hvx_params);
+        }
+
+        CRITICAL_REGION_ENTER();
+        if (NRF_SUCCESS == err_code)
+        {
+            // Unless the download has been restarted meanwhile
+            if (start == stream_seq)
+            {
+                stream_seq = seq;
+            }
+        }
+        else if ((0U != length) && (NRF_ERROR_RESOURCES != err_code))
+        {
+            // Notifications not enabled or connection lost.
+            streaming = false;
+        }
+        else if (pump_requested)
+        {
+            pump_requested = false;
+        }
+        else
+        {
+            pump_active = false;
+            active = false;
+        }
+        CRITICAL_REGION_EXIT();
+    }
+}
+
+/**@brief Returns the current time in BEACON_TRACK_TIME_UNIT_MS. */
+static uint32_t time_get(void)
+{
+    uint32_t cnt = app_timer_cnt_get();
+
+    ticks += app_timer_cnt_diff_compute(cnt, last_cnt);
+    last_cnt = cnt;
+
+    return (uint32_t)((ticks * 1000U) / (APP_TIMER_TICK_FREQ * BEACON_TRACK_TIME_UNIT_MS));
+}
\ No newline at end of file
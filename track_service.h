@@ -0,0 +1,48 @@
+#ifndef TRACK_SERVICE_H__
+#define TRACK_SERVICE_H__
+
+#include <stdint.h>
+
+#ifndef TRACK_HISTORY_SIZE
+#define TRACK_HISTORY_SIZE              4096U   /**< Number of fixes kept for download, must be a power of two. */
+#endif
+
+/* Track download service, 128 bit UUIDs based on TRACK_SERVICE_UUID_BASE, all values little endian.
+ *
+ * Control point, write:
+ *
+ * | Offset | Size | Content                                                 |
+ * |--------|------|---------------------------------------------------------|
+ * | 0      | 1    | Opcode, TRACK_SERVICE_OP_*                              |
+ * | 1      | 4    | Sequence number to start from, TRACK_SERVICE_OP_START only |
+ *
+ * Data, notify:
+ *
+ * | Offset | Size | Content                                                 |
+ * |--------|------|---------------------------------------------------------|
+ * | 0      | 4    | Sequence number of the first fix, uint32                |
+ * | 4      | 4    | Latitude in micro-degrees, int32                        |
+ * | 8      | 4    | Longitude in micro-degrees, int32                       |
+ * | 12     | 4    | Time of the fix in BEACON_TRACK_TIME_UNIT_MS, uint32    |
+ * | 16     | 12   | Next fix, as many as fit into the ATT MTU               |
+ *
+ * Every fix received gets the next sequence number. After TRACK_SERVICE_OP_START the history is
+ * notified from the given sequence number on, or from the oldest fix kept if that one is no
+ * longer available, followed by new fixes as they arrive. An interrupted download resumes by
+ * starting at the sequence number following the last one received.
+ */
+#define TRACK_SERVICE_UUID_BASE         {0x1B, 0xC5, 0xD5, 0xA5, 0x02, 0x00, 0x2F, 0x9C, \
+                                         0xE5, 0x11, 0x6A, 0x4E, 0x00, 0x00, 0x5D, 0x7A}
+#define TRACK_SERVICE_UUID              0x0001U
+#define TRACK_SERVICE_UUID_CONTROL_CHAR 0x0002U
+#define TRACK_SERVICE_UUID_DATA_CHAR    0x0003U
+
+#define TRACK_SERVICE_OP_START          0x01U   /**< Start notifying from a sequence number. */
+#define TRACK_SERVICE_OP_STOP           0x02U   /**< Stop notifying. */
+
+#define TRACK_SERVICE_HEADER_LENGTH     4U
+#define TRACK_SERVICE_RECORD_LENGTH     12U
+
+void track_service_init(void);
+
+#endif // TRACK_SERVICE_H__
\ No newline at end of file
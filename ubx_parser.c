@@ -0,0 +1,340 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include "ubx_parser.h"
+
+#define UBX_SYNC_CHAR_1             0xB5U
+#define UBX_SYNC_CHAR_2             0x62U
+#define UBX_CLASS_NAV               0x01U
+#define UBX_ID_NAV_PVT              0x07U
+#define UBX_NAV_PVT_LENGTH          92U
+
+#define UBX_NAV_PVT_FLAGS_FIX_OK    0x01U   /**< gnssFixOK flag, fix within DOP and accuracy masks. */
+#define UBX_NAV_PVT_VALID_DATE      0x01U   /**< validDate flag. */
+#define UBX_NAV_PVT_VALID_TIME      0x02U   /**< validTime flag. */
+#define UBX_FIX_TYPE_2D             2U
+#define UBX_FIX_TYPE_3D             3U
+#define UBX_FIX_TYPE_GNSS_DR        4U
+
+#define UBX_TO_MICRO_DEGREES        10L     /**< UBX coordinates are given in 1e-7 deg. */
+#define UBX_TO_CM_PER_S             10L     /**< UBX speed is given in mm/s. */
+#define UBX_TO_CENTI_DEGREES        1000L   /**< UBX heading is given in 1e-5 deg. */
+#define NANOSECONDS_PER_MS          1000000L
+#define MS_PER_DAY                  86400000L
+
+typedef enum UbxState
+{
+    UBX_STATE_SYNC_1,
+    UBX_STATE_SYNC_2,
+    UBX_STATE_CLASS,
+    UBX_STATE_ID,
+    UBX_STATE_LENGTH_LOW,
+    UBX_STATE_LENGTH_HIGH,
+    UBX_STATE_PAYLOAD,
+    UBX_STATE_CHECKSUM_A,
+    UBX_STATE_CHECKSUM_B
+} UbxStateType;
+
+/**@brief Parser context, persists between calls while a frame is being received. */
+typedef struct UbxParser
+{
+    UbxStateType state;
+    uint8_t msg_class;
+    uint8_t msg_id;
+    uint16_t length;            /**< Payload length of the current frame. */
+    uint16_t received;          /**< Payload bytes received of the current frame. */
+    uint8_t ck_a;               /**< Running 8-bit Fletcher checksum. */
+    uint8_t ck_b;
+    bool is_nav_pvt;
+    uint8_t payload[UBX_NAV_PVT_LENGTH];
+} UbxParserType;
+
+static UbxParserType parser;
+static UbxNavPvtType nav_pvt;
+
+const GnssProtocolType ubx_protocol =
+{
+    .reset  = ubx_parser_reset,
+    .parse  = ubx_parser_parse,
+    .status = ubx_parser_status
+};
+
+// Private method declarations
+static void checksum_update(uint8_t c);
+static GnssParseResultType frame_end(LocationRecordType *record);
+static void record_from_nav_pvt(LocationRecordType *record);
+static void nav_pvt_decode(const uint8_t *payload, UbxNavPvtType *pvt);
+static uint16_t read_u16(const uint8_t *buffer);
+static uint32_t read_u32(const uint8_t *buffer);
+static int32_t round_to_micro_degrees(int32_t ubx_degrees);
+
+/*
+ * Public methods
+ */
+
+/**@brief Resets the parser, any partially received frame is discarded. */
+void ubx_parser_reset(void)
+{
+    parser.state = UBX_STATE_SYNC_1;
+    nav_pvt.fix_type = 0U;
+    nav_pvt.flags = 0U;
+    nav_pvt.num_sv = 0U;
+}
+
+/**@brief Feeds one received byte to the UBX parser.
+ *
+ * @details Frames are synchronized on the sync characters and verified by the 8-bit Fletcher
+ *          checksum. Only UBX-NAV-PVT is decoded, payloads of all other messages are skipped
+ *          without being stored. A frame longer than NAV-PVT is taken for a corrupted length
+ *          and the parser resynchronizes at once instead of skipping up to 64 kB of data.
+ *          Position is already given in binary, so no decimal conversion is required. NAV-PVT
+ *          reports all optional fields of the location record except HDOP.
+ *
+ * @param[in]   c           Received byte.
+ * @param[out]  record      Location record updated on a complete NAV-PVT frame with valid fix.
+ *
+ * @returns Parse result, see @ref GnssParseResultType.
+ */
+GnssParseResultType ubx_parser_parse(uint8_t c, LocationRecordType *record)
+{
+    GnssParseResultType result = GNSS_PARSE_PENDING;
+
+    switch (parser.state)
+    {
+    case UBX_STATE_SYNC_1:
+        if (UBX_SYNC_CHAR_1 == c)
+        {
+            parser.state = UBX_STATE_SYNC_2;
+        }
+        break;
+
+    case UBX_STATE_SYNC_2:
+        if (UBX_SYNC_CHAR_2 == c)
+        {
+            parser.ck_a = 0U;
+            parser.ck_b = 0U;
+            parser.state = UBX_STATE_CLASS;
+        }
+        else
+        {
+            parser.state = (UBX_SYNC_CHAR_1 == c) ? UBX_STATE_SYNC_2 : UBX_STATE_SYNC_1;
+        }
+        break;
+
+    case UBX_STATE_CLASS:
+        checksum_update(c);
+        parser.msg_class = c;
+        parser.state = UBX_STATE_ID;
+        break;
+
+    case UBX_STATE_ID:
+        checksum_update(c);
+        parser.msg_id = c;
+        parser.state = UBX_STATE_LENGTH_LOW;
+        break;
+
+    case UBX_STATE_LENGTH_LOW:
+        checksum_update(c);
+        parser.length = c;
+        parser.state = UBX_STATE_LENGTH_HIGH;
+        break;
+
+    case UBX_STATE_LENGTH_HIGH:
+        checksum_update(c);
+        parser.length |= (uint16_t)c << 8;
+        if (parser.length > UBX_NAV_PVT_LENGTH)
+        {
+            parser.state = UBX_STATE_SYNC_1;
+            break;
+        }
+        parser.received = 0U;
+        parser.is_nav_pvt = (UBX_CLASS_NAV == parser.msg_class) &&
+                            (UBX_ID_NAV_PVT == parser.msg_id) &&
+                            (UBX_NAV_PVT_LENGTH == parser.length);
+        parser.state = (parser.length > 0U) ? UBX_STATE_PAYLOAD : UBX_STATE_CHECKSUM_A;
+        break;
+
+    case UBX_STATE_PAYLOAD:
+        checksum_update(c);
+        if (parser.is_nav_pvt)
+        {
+            parser.payload[parser.received] = c;
+        }
+        if (++parser.received >= parser.length)
+        {
+            parser.state = UBX_STATE_CHECKSUM_A;
+        }
+        break;
+
+    case UBX_STATE_CHECKSUM_A:
+        if (parser.ck_a == c)
+        {
+            parser.state = UBX_STATE_CHECKSUM_B;
+        }
+        else
+        {
+            parser.state = UBX_STATE_SYNC_1;
+            result = GNSS_PARSE_ERROR;
+        }
+        break;
+
+    case UBX_STATE_CHECKSUM_B:
+        parser.state = UBX_STATE_SYNC_1;
+        result = (parser.ck_b == c) ? frame_end(record) : GNSS_PARSE_ERROR;
+        break;
+
+    default:
+        parser.state = UBX_STATE_SYNC_1;
+        break;
+    }
+
+    return result;
+}
+
+/**@brief Returns the last decoded NAV-PVT solution. */
+const UbxNavPvtType * ubx_parser_nav_pvt(void)
+{
+    return &nav_pvt;
+}
+
+/**@brief Gets the receiver status of the last decoded NAV-PVT solution.
+ *
+ * @details Dead reckoning combined with GNSS counts as 3D fix. Dead reckoning or time only
+ *          solutions are not accepted as location and reported as no fix.
+ *
+ * @param[out]  status      Receiver status.
+ */
+void ubx_parser_status(GnssStatusType *status)
+{
+    status->satellites = nav_pvt.num_sv;
+
+    if (0U == (nav_pvt.flags & UBX_NAV_PVT_FLAGS_FIX_OK))
+    {
+        status->fix_type = LOCATION_FIX_NONE;
+    }
+    else if (UBX_FIX_TYPE_2D == nav_pvt.fix_type)
+    {
+        status->fix_type = LOCATION_FIX_2D;
+    }
+    else if ((UBX_FIX_TYPE_3D == nav_pvt.fix_type) || (UBX_FIX_TYPE_GNSS_DR == nav_pvt.fix_type))
+    {
+        status->fix_type = LOCATION_FIX_3D;
+    }
+    else
+    {
+        status->fix_type = LOCATION_FIX_NONE;
+    }
+}
+
+/*
+ * Private methods
+ */
+
+static void checksum_update(uint8_t c)
+{
+    parser.ck_a += c;
+    parser.ck_b += parser.ck_a;
+}
+
+/**@brief Evaluates a frame with verified checksum. */
+static GnssParseResultType frame_end(LocationRecordType *record)
+{
+    if (!parser.is_nav_pvt)
+    {
+        return GNSS_PARSE_IGNORED;
+    }
+
+    nav_pvt_decode(parser.payload, &nav_pvt);
+
+    if ((NULL == record) ||
+        (0U == (nav_pvt.flags & UBX_NAV_PVT_FLAGS_FIX_OK)) ||
+        (nav_pvt.fix_type < UBX_FIX_TYPE_2D) || (nav_pvt.fix_type > UBX_FIX_TYPE_GNSS_DR))
+    {
+        return GNSS_PARSE_IGNORED;
+    }
+
+    record_from_nav_pvt(record);
+
+    return GNSS_PARSE_LOCATION;
+}
+
+/**@brief Converts the NAV-PVT solution with valid fix to a location record. */
+static void record_from_nav_pvt(LocationRecordType *record)
+{
+    GnssStatusType status;
+    int32_t speed = nav_pvt.g_speed / UBX_TO_CM_PER_S;
+    int32_t course = (nav_pvt.head_mot / UBX_TO_CENTI_DEGREES) % 36000L;
+
+    ubx_parser_status(&status);
+
+    record->position.latitude  = round_to_micro_degrees(nav_pvt.lat);
+    record->position.longitude = round_to_micro_degrees(nav_pvt.lon);
+    record->altitude   = nav_pvt.h_msl;
+    record->speed      = (speed > (int32_t)UINT16_MAX) ? UINT16_MAX : (uint16_t)speed;
+    record->course     = (uint16_t)((course < 0L) ? (course + 36000L) : course);
+    record->hdop       = 0U;
+    record->pdop       = nav_pvt.p_dop;
+    record->satellites = status.satellites;
+    record->fix_type   = status.fix_type;
+    record->fields     = LOCATION_FIELD_ALTITUDE | LOCATION_FIELD_SPEED | LOCATION_FIELD_COURSE |
+                         LOCATION_FIELD_PDOP | LOCATION_FIELD_SATELLITES;
+
+    if (0U != (nav_pvt.valid & UBX_NAV_PVT_VALID_TIME))
+    {
+        // The fraction may be negative, the solution is then slightly before the second.
+        int32_t time = (((((int32_t)nav_pvt.hour * 60L) + nav_pvt.min) * 60L) + nav_pvt.sec) * 1000L +
+                       (nav_pvt.nano / NANOSECONDS_PER_MS);
+
+        record->time = (uint32_t)((time < 0L) ? (time + MS_PER_DAY) : time);
+        record->fields |= LOCATION_FIELD_TIME;
+    }
+    if ((0U != (nav_pvt.valid & UBX_NAV_PVT_VALID_DATE)) && (nav_pvt.year >= 2000U))
+    {
+        record->date = location_date_to_days(nav_pvt.year, nav_pvt.month, nav_pvt.day);
+        record->fields |= LOCATION_FIELD_DATE;
+    }
+}
+
+/**@brief Decodes the little endian NAV-PVT payload. */
+static void nav_pvt_decode(const uint8_t *payload, UbxNavPvtType *pvt)
+{
+    pvt->itow     = read_u32(&payload[0U]);
+    pvt->year     = read_u16(&payload[4U]);
+    pvt->month    = payload[6U];
+    pvt->day      = payload[7U];
+    pvt->hour     = payload[8U];
+    pvt->min      = payload[9U];
+    pvt->sec      = payload[10U];
+    pvt->valid    = payload[11U];
+    pvt->nano     = (int32_t)read_u32(&payload[16U]);
+    pvt->fix_type = payload[20U];
+    pvt->flags    = payload[21U];
+    pvt->num_sv   = payload[23U];
+    pvt->lon      = (int32_t)read_u32(&payload[24U]);
+    pvt->lat      = (int32_t)read_u32(&payload[28U]);
+    pvt->height   = (int32_t)read_u32(&payload[32U]);
+    pvt->h_msl    = (int32_t)read_u32(&payload[36U]);
+    pvt->vel_n    = (int32_t)read_u32(&payload[48U]);
+    pvt->vel_e    = (int32_t)read_u32(&payload[52U]);
+    pvt->vel_d    = (int32_t)read_u32(&payload[56U]);
+    pvt->g_speed  = (int32_t)read_u32(&payload[60U]);
+    pvt->head_mot = (int32_t)read_u32(&payload[64U]);
+    pvt->p_dop    = read_u16(&payload[76U]);
+}
+
+static uint16_t read_u16(const uint8_t *buffer)
+{
+    return (uint16_t)buffer[0U] | ((uint16_t)buffer[1U] << 8);
+}
+
+static uint32_t read_u32(const uint8_t *buffer)
+{
+    return (uint32_t)buffer[0U] | ((uint32_t)buffer[1U] << 8) |
+           ((uint32_t)buffer[2U] << 16) | ((uint32_t)buffer[3U] << 24);
+}
+
+static int32_t round_to_micro_degrees(int32_t ubx_degrees)
+{
+    int32_t half = (ubx_degrees < 0) ? -(UBX_TO_MICRO_DEGREES / 2) : (UBX_TO_MICRO_DEGREES / 2);
+
+    return (ubx_degrees + half) / UBX_TO_MICRO_DEGREES;
+}
\ No newline at end of file
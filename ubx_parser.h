@@ -0,0 +1,41 @@
+#ifndef UBX_PARSER_H__
+#define UBX_PARSER_H__
+
+#include <stdint.h>
+#include "gnss_protocol.h"
+
+/**@brief Navigation position velocity time solution (UBX-NAV-PVT). */
+typedef struct UbxNavPvt
+{
+    uint32_t itow;          /**< GPS time of week [ms]. */
+    uint16_t year;          /**< UTC year. */
+    uint8_t month;          /**< UTC month, 1..12. */
+    uint8_t day;            /**< UTC day of month, 1..31. */
+    uint8_t hour;           /**< UTC hour, 0..23. */
+    uint8_t min;            /**< UTC minute, 0..59. */
+    uint8_t sec;            /**< UTC second, 0..60. */
+    uint8_t valid;          /**< Validity flags of date and time. */
+    int32_t nano;           /**< Fraction of second [ns]. */
+    uint8_t fix_type;       /**< 0: no fix, 2: 2D, 3: 3D, 4: GNSS + dead reckoning, 5: time only. */
+    uint8_t flags;          /**< Fix status flags, bit 0 is gnssFixOK. */
+    uint8_t num_sv;         /**< Number of satellites used. */
+    int32_t lon;            /**< Longitude [1e-7 deg]. */
+    int32_t lat;            /**< Latitude [1e-7 deg]. */
+    int32_t height;         /**< Height above ellipsoid [mm]. */
+    int32_t h_msl;          /**< Height above mean sea level [mm]. */
+    int32_t vel_n;          /**< North velocity [mm/s]. */
+    int32_t vel_e;          /**< East velocity [mm/s]. */
+    int32_t vel_d;          /**< Down velocity [mm/s]. */
+    int32_t g_speed;        /**< Ground speed [mm/s]. */
+    int32_t head_mot;       /**< Heading of motion [1e-5 deg]. */
+    uint16_t p_dop;         /**< Position DOP [0.01]. */
+} UbxNavPvtType;
+
+extern const GnssProtocolType ubx_protocol;
+
+void ubx_parser_reset(void);
+GnssParseResultType ubx_parser_parse(uint8_t c, LocationRecordType *record);
+void ubx_parser_status(GnssStatusType *status);
+const UbxNavPvtType * ubx_parser_nav_pvt(void);
+
+#endif // UBX_PARSER_H__
\ No newline at end of file